@@ -22,6 +22,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -44,11 +45,19 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, bool highQuality, int id, bool permanent);
 	~Channel();
 
+	/**
+	 * Prepares the channel for mixing, by capturing its current volume.
+	 * Must be called with the mixer mutex held.
+	 */
+	void beginMix();
+
 	/**
 	 * Mixes the channel's samples into the given buffer.
+	 * Only the stream and the rate converter are used, so this does not need
+	 * the mixer mutex to be held.
 	 *
 	 * @param data buffer where to mix the data
 	 * @param len  number of sample *pairs*. So a value of
@@ -58,6 +67,12 @@ public:
 	 */
 	int mix(int16 *data, uint len);
 
+	/**
+	 * Updates the channel's playback position after mixing.
+	 * Must be called with the mixer mutex held.
+	 */
+	void endMix();
+
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
@@ -165,6 +180,12 @@ private:
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
 
+	// State of the mix in progress
+	st_volume_t _mixVolL, _mixVolR;
+	bool _mixed;
+	uint32 _mixTimeStamp;
+	int _mixedSamples;
+
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
 };
@@ -175,7 +196,9 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _mixMutex(), _mixing(false), _sampleRate(sampleRate),
+	  _highQualityResampling(ConfMan.hasKey("high_quality_resampling") && ConfMan.getBool("high_quality_resampling")),
+	  _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
 
 	assert(sampleRate > 0);
 
@@ -229,8 +252,6 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == 0) {
 		warning("stream is 0");
 		return;
@@ -239,6 +260,18 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+#ifdef AUDIO_REVERSE_STEREO
+	reverseStereo = !reverseStereo;
+#endif
+
+	// Create the channel before locking, so that the mixer callback
+	// does not wait for the rate converter to be set up
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, _highQualityResampling, id, permanent);
+	chan->setVolume(volume);
+	chan->setBalance(balance);
+
+	Common::StackLock lock(_mutex);
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
@@ -249,27 +282,18 @@ void MixerImpl::playStream(
 				// keep in mind here is QueuingAudioStream.
 				// Thus, as a quick rule of thumb, you should never, ever,
 				// try to play QueuingAudioStreams with a sound id.
-				if (autofreeStream == DisposeAfterUse::YES)
-					delete stream;
+				delete chan;
 				return;
 			}
 	}
 
-#ifdef AUDIO_REVERSE_STEREO
-	reverseStereo = !reverseStereo;
-#endif
-
-	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
-	chan->setVolume(volume);
-	chan->setBalance(balance);
 	insertChannel(handle, chan);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	Common::StackLock mixLock(_mixMutex);
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -282,54 +306,117 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
-	// mix all channels
-	int res = 0, tmp;
+	// collect the channels to mix
+	Channel *mixed[NUM_CHANNELS];
+	Channel *finished[NUM_CHANNELS];
+	int mixedCount = 0, finishedCount = 0;
+
+	_mutex.lock();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
+				finished[finishedCount++] = _channels[i];
 				_channels[i] = 0;
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
+				_channels[i]->beginMix();
+				mixed[mixedCount++] = _channels[i];
 			}
 		}
+	_mixing = true;
+	_mutex.unlock();
+
+	// mix all channels, without blocking the mixer API meanwhile.
+	// Channels stopped from now on are deleted once the callback returns.
+	int res = 0, tmp;
+	for (int i = 0; i != mixedCount; i++) {
+		tmp = mixed[i]->mix(buf, len);
+
+		if (tmp > res)
+			res = tmp;
+	}
+
+	_mutex.lock();
+	for (int i = 0; i != mixedCount; i++)
+		mixed[i]->endMix();
+	_mixing = false;
+	_mutex.unlock();
+
+	for (int i = 0; i != finishedCount; i++)
+		delete finished[i];
 
 	return res;
 }
 
+void MixerImpl::deleteChannels(Channel **channels, int count, bool mixing) {
+	if (count == 0)
+		return;
+
+	// Wait for the mixer callback to be done with the channels
+	if (mixing) {
+		_mixMutex.lock();
+		_mixMutex.unlock();
+	}
+
+	for (int i = 0; i != count; i++)
+		delete channels[i];
+}
+
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Channel *stopped[NUM_CHANNELS];
+	int stoppedCount = 0;
+	bool mixing;
+
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
+				stopped[stoppedCount++] = _channels[i];
+				_channels[i] = 0;
+			}
 		}
+		mixing = _mixing;
 	}
+
+	deleteChannels(stopped, stoppedCount, mixing);
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Channel *stopped[NUM_CHANNELS];
+	int stoppedCount = 0;
+	bool mixing;
+
+	{
+		Common::StackLock lock(_mutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+				stopped[stoppedCount++] = _channels[i];
+				_channels[i] = 0;
+			}
 		}
+		mixing = _mixing;
 	}
+
+	deleteChannels(stopped, stoppedCount, mixing);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Channel *stopped;
+	bool mixing;
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	{
+		Common::StackLock lock(_mutex);
+
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = handle._val % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+			return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+		stopped = _channels[index];
+		_channels[index] = 0;
+		mixing = _mixing;
+	}
+
+	deleteChannels(&stopped, 1, mixing);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
@@ -500,16 +587,17 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, bool highQuality, int id, bool permanent)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+      _pauseStartTime(0), _pauseTime(0), _mixVolL(0), _mixVolR(0), _mixed(false), _mixTimeStamp(0),
+      _mixedSamples(0), _converter(0), _volL(0), _volR(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, highQuality);
 }
 
 Channel::~Channel() {
@@ -607,6 +695,11 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
+void Channel::beginMix() {
+	_mixVolL = _volL;
+	_mixVolR = _volR;
+}
+
 int Channel::mix(int16 *data, uint len) {
 	assert(_stream);
 
@@ -615,14 +708,24 @@ int Channel::mix(int16 *data, uint len) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
-		_samplesConsumed = _samplesDecoded;
-		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
-		_samplesDecoded += res;
+		_mixed = true;
+		_mixTimeStamp = g_system->getMillis(true);
+		res = _converter->flow(*_stream, data, len, _mixVolL, _mixVolR);
+		_mixedSamples = res;
 	}
 
 	return res;
 }
 
+void Channel::endMix() {
+	if (!_mixed)
+		return;
+
+	_samplesConsumed = _samplesDecoded;
+	_mixerTimeStamp = _mixTimeStamp;
+	_pauseTime = 0;
+	_samplesDecoded += _mixedSamples;
+	_mixed = false;
+}
+
 } // End of namespace Audio
@@ -54,9 +54,25 @@ private:
 		NUM_CHANNELS = 32 // ResidualVM specific
 	};
 
+	/**
+	 * Protects the channel list and the channel settings. The mixer callback
+	 * only holds it while collecting the channels to mix and when done, not
+	 * while the channels are being mixed.
+	 */
 	Common::Mutex _mutex;
 
+	/** Held by the mixer callback for its whole duration */
+	Common::Mutex _mixMutex;
+
+	/** Whether the mixer callback is mixing channels without holding _mutex */
+	bool _mixing;
+
 	const uint _sampleRate;
+	/**
+	 * Whether the channels are upsampled with a windowed sinc filter, which
+	 * costs 1.5 to 2 times as much as the linear interpolation.
+	 */
+	const bool _highQualityResampling;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -121,6 +137,13 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Delete channels that were removed from the channel list.
+	 * Must be called without holding _mutex. If the mixer callback was
+	 * mixing when the channels were removed, wait for it to be done with them.
+	 */
+	void deleteChannels(Channel **channels, int count, bool mixing);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
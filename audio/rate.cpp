@@ -31,6 +31,7 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -57,6 +58,36 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Mix sample frames into the output buffer, scaled by the channel volumes.
+ *
+ * This is shared by all the rate converters, which first convert the
+ * input into a buffer of frames. It is kept as a plain loop over arrays,
+ * without dependencies between iterations, so that compilers can
+ * vectorize it.
+ *
+ * @param obuf   interleaved stereo output buffer
+ * @param ibuf   input frames, interleaved if stereo
+ * @param frames number of frames to mix
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFrames(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// The left input channel is output to obuf[reverseStereo], the right one to the other
+	const int vol0 = reverseStereo ? vol_r : vol_l;
+	const int vol1 = reverseStereo ? vol_l : vol_r;
+
+	for (st_size_t i = 0; i < frames; i++) {
+		const int in0 = ibuf[stereo && reverseStereo ? 1 : 0];
+		const int in1 = ibuf[stereo && !reverseStereo ? 1 : 0];
+
+		clampedAdd(obuf[0], (in0 * vol0) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (in1 * vol1) / Audio::Mixer::kMaxMixerVolume);
+
+		ibuf += stereo ? 2 : 1;
+		obuf += 2;
+	}
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -113,45 +144,47 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+	const int channels = stereo ? 2 : 1;
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		// Check if we have to refill the buffer
+		if (inLen == 0) {
+			inPtr = inBuf;
+			inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+			if (inLen <= 0)
+				return done;
+		}
 
-		// Increment output position
-		opos += opos_inc;
+		// The next output frame is the input frame after the 'opos' next ones
+		long available = inLen / channels;
+		if (opos >= available) {
+			inPtr += available * channels;
+			inLen -= available * channels;
+			opos -= available;
+			continue;
+		}
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		// Pick the output frames from the buffered input
+		st_size_t count = MIN<st_size_t>((available - opos - 1) / opos_inc + 1, osamp - done);
+		const st_sample_t *src = inPtr + opos * channels;
+		for (st_size_t i = 0; i < count; i++) {
+			frames[i * channels] = src[0];
+			if (stereo)
+				frames[i * channels + 1] = src[1];
+			src += opos_inc * channels;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		long consumed = opos + (count - 1) * opos_inc + 1;
+		inPtr += consumed * channels;
+		inLen -= consumed * channels;
+		opos = opos_inc - 1;
 
-		obuf += 2;
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, frames, count, vol_l, vol_r);
+		done += count;
 	}
-	return (obuf - ostart) / 2;
+	return done;
 }
 
 /**
@@ -222,55 +255,291 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+	const int channels = stereo ? 2 : 1;
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		// Interpolate a batch of frames, then mix them all at once
+		st_size_t count = MIN<st_size_t>(ARRAYSIZE(frames) / channels, osamp - done);
+		st_sample_t *out = frames;
+		st_sample_t *outEnd = frames + count * channels;
+		bool endOfInput = false;
+
+		while (out < outEnd) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= channels;
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
+			}
 
-	ostart = obuf;
-	oend = obuf + osamp * 2;
+			if (endOfInput)
+				break;
 
-	while (obuf < oend) {
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && out < outEnd) {
+				// interpolate
+				*out++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*out++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		count = (out - frames) / channels;
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, frames, count, vol_l, vol_r);
+		done += count;
+
+		if (endOfInput)
+			break;
+	}
+	return done;
+}
+
+
+#pragma mark -
+
+
+/**
+ * Audio rate converter interpolating with a windowed sinc filter.
+ *
+ * Every output frame is the dot product of SINC_TAPS input frames with one
+ * of the phases of a polyphase filter. With the reduced ratio of the rates
+ * outrate / inrate = L / M, the output frames cycle through exactly L phases,
+ * so the coefficients of all the phases are computed once in fixed point
+ * when the converter is created and the filtering is integer only.
+ *
+ * This removes most of the imaging the linear interpolation adds when
+ * upsampling. It is only used for upsampling, when the number of phases
+ * does not exceed SINC_MAX_PHASES.
+ */
+
+enum {
+	/** Number of input frames contributing to each output frame */
+	SINC_TAPS = 16,
+	/** Maximum number of phases of the filter, 11025 to 48000Hz needs 640 */
+	SINC_MAX_PHASES = 1024,
+	SINC_COEF_BITS = 14
+};
+
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/**
+	 * The input frames of each channel still needed by the filter,
+	 * starting with the oldest one.
+	 */
+	st_sample_t _history[2][SINC_TAPS + INTERMEDIATE_BUFFER_SIZE];
+	/** Number of frames in the history */
+	int _historyLen;
+	/** Index in the history of the first frame filtered for the next output frame */
+	int _historyPos;
+
+	/** SINC_TAPS coefficients for each phase */
+	int16 *_coefs;
+	/** Phase of the next output frame */
+	uint32 _phase;
+	/** Number of phases of the filter */
+	uint32 _phaseCount;
+	/** Phase increment for each output frame, in input frames times _phaseCount */
+	uint32 _phaseInc;
+	/** Whether the silence following the end of the input was appended to the history */
+	bool _tailAppended;
+
+	bool refill(AudioStream &input);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter();
+
+	static bool canConvert(st_rate_t inrate, st_rate_t outrate);
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+/**
+ * Zeroth order modified Bessel function of the first kind,
+ * used by the Kaiser window.
+ */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32 && term > sum * 1e-12; k++) {
+		term *= (x * x) / (4.0 * k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::canConvert(st_rate_t inrate, st_rate_t outrate) {
+	return inrate < outrate && outrate / Common::gcd(inrate, outrate) <= SINC_MAX_PHASES;
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	assert(canConvert(inrate, outrate));
+
+	const st_rate_t gcd = Common::gcd(inrate, outrate);
+	_phaseCount = outrate / gcd;
+	_phaseInc = inrate / gcd;
+	_phase = 0;
+
+	// Cut off slightly below the input Nyquist frequency, to leave room
+	// for the transition band of such a short filter
+	const double cutoff = 0.45;
+	const double beta = 6.0;
+	const double i0Beta = besselI0(beta);
+
+	_coefs = new int16[_phaseCount * SINC_TAPS];
+	for (uint32 p = 0; p < _phaseCount; p++) {
+		double coefs[SINC_TAPS];
+		double sum = 0.0;
+
+		for (int k = 0; k < SINC_TAPS; k++) {
+			// Distance in input frames between the tap and the output frame
+			const double t = k - (SINC_TAPS / 2 - 1) - (double)p / _phaseCount;
+			const double x = 2.0 * cutoff * t;
+			const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			const double r = t / (SINC_TAPS / 2);
+			const double window = (r * r < 1.0) ? besselI0(beta * sqrt(1.0 - r * r)) / i0Beta : 0.0;
+
+			coefs[k] = sinc * window;
+			sum += coefs[k];
+		}
+
+		// Normalize each phase to a unity gain, so that constant input
+		// does not get modulated at the phase period. The rounding error
+		// goes to the largest coefficient, to keep the gain exact.
+		int16 *phaseCoefs = _coefs + p * SINC_TAPS;
+		int total = 0, largest = 0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			phaseCoefs[k] = (int16)floor(coefs[k] / sum * (1 << SINC_COEF_BITS) + 0.5);
+			total += phaseCoefs[k];
+			if (phaseCoefs[k] > phaseCoefs[largest])
+				largest = k;
+		}
+		phaseCoefs[largest] += (1 << SINC_COEF_BITS) - total;
+	}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+	// Start with silence, so that the first output frame is centered on the
+	// first input frame
+	memset(_history, 0, sizeof(_history));
+	_historyLen = SINC_TAPS / 2 - 1;
+	_historyPos = 0;
+	_tailAppended = false;
+}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	delete[] _coefs;
+}
 
-			obuf += 2;
+/*
+ * Drop the history frames no longer needed and append a buffer of input frames.
+ * At the end of the stream, append once the silence the filter needs to reach
+ * the last input frames.
+ * Return false when there is nothing to append.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	const int channels = stereo ? 2 : 1;
+
+	const int kept = _historyLen - _historyPos;
+	for (int c = 0; c < channels; c++)
+		memmove(_history[c], _history[c] + _historyPos, kept * sizeof(st_sample_t));
+	_historyLen = kept;
+	_historyPos = 0;
+
+	const int len = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+	if (len <= 0) {
+		if (_tailAppended || !input.endOfStream())
+			return false;
+
+		for (int c = 0; c < channels; c++)
+			memset(_history[c] + _historyLen, 0, (SINC_TAPS / 2) * sizeof(st_sample_t));
+		_historyLen += SINC_TAPS / 2;
+		_tailAppended = true;
+		return true;
+	}
+
+	const st_sample_t *in = inBuf;
+	const int frames = len / channels;
+	for (int i = 0; i < frames; i++) {
+		_history[0][_historyLen + i] = *in++;
+		if (stereo)
+			_history[1][_historyLen + i] = *in++;
+	}
+	_historyLen += frames;
+	return true;
+}
 
-			// Increment output position
-			opos += opos_inc;
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+int SincRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const int channels = stereo ? 2 : 1;
+	st_sample_t frames[INTERMEDIATE_BUFFER_SIZE];
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		// Filter a batch of frames, then mix them all at once
+		const st_size_t count = MIN<st_size_t>(ARRAYSIZE(frames) / channels, osamp - done);
+		st_size_t filtered = 0;
+
+		while (filtered < count && _historyPos + SINC_TAPS <= _historyLen) {
+			const int16 *coefs = _coefs + _phase * SINC_TAPS;
+
+			for (int c = 0; c < channels; c++) {
+				const st_sample_t *in = _history[c] + _historyPos;
+				int acc = 0;
+				for (int k = 0; k < SINC_TAPS; k++)
+					acc += in[k] * coefs[k];
+
+				acc = (acc + (1 << (SINC_COEF_BITS - 1))) >> SINC_COEF_BITS;
+				frames[filtered * channels + c] = (st_sample_t)CLIP<int>(acc, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			}
+			filtered++;
+
+			// When upsampling, the next output frame is at most one input frame further
+			_phase += _phaseInc;
+			if (_phase >= _phaseCount) {
+				_phase -= _phaseCount;
+				_historyPos++;
+			}
 		}
+
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, frames, filtered, vol_l, vol_r);
+		done += filtered;
+
+		if (filtered < count && !refill(input))
+			break;
 	}
-	return (obuf - ostart) / 2;
+	return done;
 }
 
 
@@ -293,11 +562,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -312,24 +576,14 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		st_size_t frames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -341,9 +595,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool highQuality) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (highQuality && SincRateConverter<stereo, reverseStereo>::canConvert(inrate, outrate)) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -355,15 +611,17 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 
 /**
  * Create and return a RateConverter object for the specified input and output rates.
+ * When highQuality is set, upsampling is done with a windowed sinc filter
+ * whenever the rates allow it.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, bool highQuality) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, highQuality);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, highQuality);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, highQuality);
 }
 
 } // End of namespace Audio
@@ -446,8 +446,9 @@ public:
 
 /**
  * Create and return a RateConverter object for the specified input and output rates.
+ * There is no windowed sinc converter in ARM assembly, so highQuality is ignored.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, bool highQuality) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
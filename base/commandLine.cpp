@@ -118,6 +118,10 @@ static const char HELP_STRING[] =
 	"  --native-mt32            True Roland MT-32 (disable GM emulation)\n"
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
+	"  --[no-]high-quality-resampling\n"
+	"                           Upsample sounds with a windowed sinc filter instead of\n"
+	"                           linear interpolation. Expensive: it takes 1.5 to 2 times\n"
+	"                           as much CPU time (default: disabled)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame)\n"
 	"  --talkspeed=NUM          Set talk speed for games (default: 179)\n"
 	"  --show-fps               Set the turn on display FPS info\n"
@@ -128,6 +132,10 @@ static const char HELP_STRING[] =
 	"                           (default: 0) (only supported by software renderer)\n"
 	"  --[no-]dirtyrects        Enable dirty rectangles optimisation in software renderer\n"
 	"                           (default: enabled)\n"
+	"  --[no-]tiledrendering    Replay the frame tile by tile in software renderer when\n"
+	"                           dirty rectangles are disabled (default: disabled)\n"
+	"  --[no-]texturefiltering  Honour the linear and mipmap texture filters in software\n"
+	"                           renderer (default: disabled)\n"
 #ifdef ENABLE_EVENTRECORDER
 	"  --record-mode=MODE       Specify record mode for event recorder (record, playback,\n"
 	"                           passthrough [default])\n"
@@ -174,6 +182,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("show_fps", false);
 	ConfMan.registerDefault("aspect_ratio", false);
 	ConfMan.registerDefault("dirtyrects", true);
+	ConfMan.registerDefault("tiledrendering", false);
+	ConfMan.registerDefault("texturefiltering", false);
 	ConfMan.registerDefault("bpp", 0);
 
 	// Sound & Music
@@ -185,6 +195,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("sfx_mute", false);
 	ConfMan.registerDefault("speech_mute", false);
 	ConfMan.registerDefault("mute", false);
+	ConfMan.registerDefault("high_quality_resampling", false);
 
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
@@ -421,6 +432,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_INT("output-rate")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("high-quality-resampling")
+			END_OPTION
+
 			DO_OPTION_BOOL('f', "fullscreen")
 			END_OPTION
 
@@ -520,6 +534,12 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("dirtyrects")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("tiledrendering")
+			END_OPTION
+
+			DO_LONG_OPTION_BOOL("texturefiltering")
+			END_OPTION
+
 			DO_LONG_OPTION("gamma")
 			END_OPTION
 // ResidualVM specific start
@@ -268,6 +268,57 @@ uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+void LockedSeekableReadStream::incRef() {
+	StackLock lock(_mutex);
+	_refCount++;
+}
+
+void LockedSeekableReadStream::decRef() {
+	bool unused;
+	{
+		StackLock lock(_mutex);
+		unused = --_refCount == 0;
+	}
+	if (unused)
+		delete this;
+}
+
+uint32 LockedSeekableReadStream::read(uint32 offset, void *dataPtr, uint32 dataSize) {
+	StackLock lock(_mutex);
+	if (!_stream->seek(offset, SEEK_SET))
+		return 0;
+	return _stream->read(dataPtr, dataSize);
+}
+
+uint32 LockedSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > _end - _pos) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	uint32 bytesRead = _parentStream->read(_pos, dataPtr, dataSize);
+	if (bytesRead != dataSize)
+		_err = true;
+
+	_pos += bytesRead;
+	return bytesRead;
+}
+
+bool LockedSeekableSubReadStream::seek(int32 offset, int whence) {
+	int32 newPos = offset;
+	if (whence == SEEK_CUR)
+		newPos += pos();
+	else if (whence == SEEK_END)
+		newPos += size();
+
+	if (newPos < 0 || newPos > size())
+		return false;
+
+	_pos = _begin + newPos;
+	_eos = false;
+	return true;
+}
+
 void SeekableReadStream::hexdump(int len, int bytesPerLine, int startOffset) {
 	uint pos_ = pos();
 	uint size_ = size();
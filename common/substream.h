@@ -23,6 +23,7 @@
 #ifndef COMMON_SUBSTREAM_H
 #define COMMON_SUBSTREAM_H
 
+#include "common/mutex.h"
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/types.h"
@@ -116,6 +117,80 @@ public:
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
 };
 
+/**
+ * A seekable stream shared by several LockedSeekableSubReadStream, which may
+ * be used from different threads (e.g. the main thread and the audio thread).
+ * Each read seeks the stream and reads from it while holding a lock.
+ *
+ * The object is reference counted under the same lock, since the references
+ * are taken and dropped from different threads as well. Its creator owns the
+ * first reference, and the stream is deleted with the last one.
+ */
+class LockedSeekableReadStream {
+public:
+	LockedSeekableReadStream(SeekableReadStream *stream) : _stream(stream), _refCount(1) {
+		assert(stream);
+	}
+
+	void incRef();
+	void decRef();
+
+	/**
+	 * Reads dataSize bytes starting at offset in the stream.
+	 *
+	 * @return the number of bytes read, 0 if offset can't be reached
+	 */
+	uint32 read(uint32 offset, void *dataPtr, uint32 dataSize);
+
+private:
+	~LockedSeekableReadStream() { delete _stream; }
+
+	SeekableReadStream *_stream;
+	uint32 _refCount;
+	Mutex _mutex;
+};
+
+/**
+ * A substream of a LockedSeekableReadStream, restricted to the range
+ * [begin, end). Any number of them can be used at the same time, from any
+ * thread, without opening the parent stream again.
+ *
+ * Seeking outside of the range fails, leaving the position and the error
+ * indicator untouched.
+ */
+class LockedSeekableSubReadStream : public SeekableReadStream {
+protected:
+	LockedSeekableReadStream *_parentStream;
+	uint32 _begin;
+	uint32 _end;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+public:
+	LockedSeekableSubReadStream(LockedSeekableReadStream *parentStream, uint32 begin, uint32 end)
+		: _parentStream(parentStream),
+		  _begin(begin),
+		  _end(end),
+		  _pos(begin),
+		  _eos(false),
+		  _err(false) {
+		assert(parentStream);
+		assert(begin <= end);
+		_parentStream->incRef();
+	}
+	~LockedSeekableSubReadStream() { _parentStream->decRef(); }
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = _err = false; }
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _pos - _begin; }
+	virtual int32 size() const { return _end - _begin; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+};
+
 
 } // End of namespace Common
 
@@ -230,12 +230,36 @@ void EMIModel::setSkeleton(Skeleton *skel) {
 	for (int i = 0; i < _numBoneInfos; i++) {
 		_vertexBoneInfo[i] = _skeleton->findJointIndex(_boneNames[_boneInfos[i]._joint]);
 	}
+	delete[] _skinningMatrices;
+	_skinningMatrices = new float[12 * _skeleton->_numJoints];
+}
+
+void EMIModel::updateSkinningMatrices() {
+	// The skinning matrix of a joint is its final matrix times the inverse of its bind pose,
+	// which is a rigid transform: the inverse rotation is the transposed one.
+	for (int j = 0; j < _skeleton->_numJoints; j++) {
+		const Math::Matrix4 &jointMatrix = _skeleton->_joints[j]._finalMatrix;
+		const Math::Matrix4 &bindPose = _skeleton->_joints[j]._absMatrix;
+		float *m = &_skinningMatrices[12 * j];
+		for (int row = 0; row < 3; row++) {
+			for (int col = 0; col < 3; col++) {
+				m[row * 4 + col] = jointMatrix.getValue(row, 0) * bindPose.getValue(col, 0) +
+				                   jointMatrix.getValue(row, 1) * bindPose.getValue(col, 1) +
+				                   jointMatrix.getValue(row, 2) * bindPose.getValue(col, 2);
+			}
+			m[row * 4 + 3] = jointMatrix.getValue(row, 3) - (m[row * 4 + 0] * bindPose.getValue(0, 3) +
+			                                                 m[row * 4 + 1] * bindPose.getValue(1, 3) +
+			                                                 m[row * 4 + 2] * bindPose.getValue(2, 3));
+		}
+	}
 }
 
 void EMIModel::prepareForRender() {
 	if (!_skeleton || !_vertexBoneInfo)
 		return;
 
+	updateSkinningMatrices();
+
 	for (int i = 0; i < _numVertices; i++) {
 		_drawVertices[i].set(0.0f, 0.0f, 0.0f);
 		_drawNormals[i].set(0.0f, 0.0f, 0.0f);
@@ -247,20 +271,20 @@ void EMIModel::prepareForRender() {
 			boneVert++;
 		}
 
-		int jointIndex = _vertexBoneInfo[i];
-		const Math::Matrix4 &jointMatrix = _skeleton->_joints[jointIndex]._finalMatrix;
-		const Math::Matrix4 &bindPose = _skeleton->_joints[jointIndex]._absMatrix;
+		const float *m = &_skinningMatrices[12 * _vertexBoneInfo[i]];
+		const float weight = _boneInfos[i]._weight;
 
-		Math::Vector3d vert = _vertices[boneVert];
-		bindPose.inverseTranslate(&vert);
-		bindPose.inverseRotate(&vert);
-		jointMatrix.transform(&vert, true);
-		_drawVertices[boneVert] += vert * _boneInfos[i]._weight;
+		const float *vert = _vertices[boneVert].getData();
+		float *drawVert = _drawVertices[boneVert].getData();
+		drawVert[0] += (m[0] * vert[0] + m[1] * vert[1] + m[2] * vert[2] + m[3]) * weight;
+		drawVert[1] += (m[4] * vert[0] + m[5] * vert[1] + m[6] * vert[2] + m[7]) * weight;
+		drawVert[2] += (m[8] * vert[0] + m[9] * vert[1] + m[10] * vert[2] + m[11]) * weight;
 
-		Math::Vector3d normal = _normals[boneVert];
-		bindPose.inverseRotate(&normal);
-		jointMatrix.transform(&normal, false);
-		_drawNormals[boneVert] += normal * _boneInfos[i]._weight;
+		const float *normal = _normals[boneVert].getData();
+		float *drawNormal = _drawNormals[boneVert].getData();
+		drawNormal[0] += (m[0] * normal[0] + m[1] * normal[1] + m[2] * normal[2]) * weight;
+		drawNormal[1] += (m[4] * normal[0] + m[5] * normal[1] + m[6] * normal[2]) * weight;
+		drawNormal[2] += (m[8] * normal[0] + m[9] * normal[1] + m[10] * normal[2]) * weight;
 	}
 
 	for (int i = 0; i < _numVertices; i++) {
@@ -293,10 +317,8 @@ void EMIModel::draw() {
 		// If shaders are not available, we calculate lighting in software.
 		Actor::LightMode lightMode = actor->getLightMode();
 		if (lightMode != Actor::LightNone) {
-			if (lightMode != Actor::LightStatic)
-				_lightingDirty = true;
-
-			if (_lightingDirty) {
+			// Static lighting is computed once, dynamic lighting whenever the model or the lights change.
+			if (lightMode != Actor::LightStatic || _lightingDirty) {
 				updateLighting(modelToWorld);
 				_lightingDirty = false;
 			}
@@ -318,24 +340,107 @@ void EMIModel::draw() {
 	}
 }
 
+/**
+ * A light affecting a model, with the values used for every vertex computed once.
+ */
+struct ActiveLight {
+	const Light *light;
+	Math::Vector3d color;
+	float falloffNearSq, falloffFarSq;
+	float cosUmbra, cosPenumbra;
+};
+
+/**
+ * Compares a value with the one stored at the same position in the previous frame, and stores it.
+ */
+static void updateLightingKey(Common::Array<float> &key, uint &pos, bool &changed, float value) {
+	if (pos == key.size()) {
+		key.push_back(value);
+		changed = true;
+	} else if (key[pos] != value) {
+		key[pos] = value;
+		changed = true;
+	}
+	++pos;
+}
+
 void EMIModel::updateLighting(const Math::Matrix4 &modelToWorld) {
 	// Current lighting implementation mimics the NormDyn mode of the original game, even if
 	// FastDyn is requested. We assume that FastDyn mode was used only for the purpose of
 	// performance optimization, but NormDyn mode is visually superior in all cases.
 
-	Common::Array<Grim::Light *> activeLights;
+	Common::Array<ActiveLight> activeLights;
 	bool hasAmbient = false;
 
 	Actor *actor = _costume->getOwner();
 
+	// The lighting only has to be computed again if the pose of the model or the lights changed.
+	uint keyPos = 0;
+	bool changed = _lightingDirty;
+	for (int i = 0; i < 16; i++)
+		updateLightingKey(_lightingKey, keyPos, changed, modelToWorld.getData()[i]);
+	if (_skeleton && _skinningMatrices) {
+		for (int i = 0; i < 12 * _skeleton->_numJoints; i++)
+			updateLightingKey(_lightingKey, keyPos, changed, _skinningMatrices[i]);
+	}
+
+	Math::AABB bounds = calculateWorldBounds(modelToWorld);
+
 	foreach(Light *l, g_grim->getCurrSet()->getLights(actor->isInOverworld())) {
-		if (l->_enabled) {
-			activeLights.push_back(l);
-			if (l->_type == Light::Ambient)
-				hasAmbient = true;
+		if (!l->_enabled)
+			continue;
+
+		updateLightingKey(_lightingKey, keyPos, changed, l->_type);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_intensity);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_umbraangle);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_penumbraangle);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_falloffNear);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_falloffFar);
+		updateLightingKey(_lightingKey, keyPos, changed, l->_color.getRed());
+		updateLightingKey(_lightingKey, keyPos, changed, l->_color.getGreen());
+		updateLightingKey(_lightingKey, keyPos, changed, l->_color.getBlue());
+		for (int i = 0; i < 3; i++) {
+			updateLightingKey(_lightingKey, keyPos, changed, l->_pos.getData()[i]);
+			updateLightingKey(_lightingKey, keyPos, changed, l->_dir.getData()[i]);
+		}
+
+		if (l->_type == Light::Ambient)
+			hasAmbient = true;
+
+		ActiveLight light;
+		light.light = l;
+		light.falloffNearSq = l->_falloffNear * l->_falloffNear;
+		light.falloffFarSq = l->_falloffFar * l->_falloffFar;
+
+		// Lights too far from the whole model can not light any of its vertices.
+		if ((l->_type == Light::Omni || l->_type == Light::Spot) && bounds.isValid()) {
+			float distSq = 0.0f;
+			for (int i = 0; i < 3; i++) {
+				float d = MAX(MAX(bounds.getMin().getData()[i] - l->_pos.getData()[i], l->_pos.getData()[i] - bounds.getMax().getData()[i]), 0.0f);
+				distSq += d * d;
+			}
+			if (distSq > light.falloffFarSq)
+				continue;
 		}
+
+		// Compare the cosines of the spot angles instead of computing the angle of every vertex.
+		// The angle is at most pi / 2 for lit vertices, so larger angles clamp to never culling.
+		light.cosUmbra = cosf(CLIP<float>(l->_umbraangle, 0.0f, M_PI));
+		light.cosPenumbra = cosf(CLIP<float>(l->_penumbraangle, 0.0f, M_PI));
+
+		light.color.x() = l->_color.getRed() / 255.0f;
+		light.color.y() = l->_color.getGreen() / 255.0f;
+		light.color.z() = l->_color.getBlue() / 255.0f;
+		activeLights.push_back(light);
 	}
 
+	if (keyPos != _lightingKey.size()) {
+		_lightingKey.resize(keyPos);
+		changed = true;
+	}
+	if (!changed)
+		return;
+
 	for (int i = 0; i < _numVertices; i++) {
 		Math::Vector3d &result = _lighting[i];
 		result.set(0.0f, 0.0f, 0.0f);
@@ -346,7 +451,8 @@ void EMIModel::updateLighting(const Math::Matrix4 &modelToWorld) {
 		modelToWorld.transform(&normal, false);
 
 		for (uint j = 0; j < activeLights.size(); ++j) {
-			Light *l = activeLights[j];
+			const ActiveLight &light = activeLights[j];
+			const Light *l = light.light;
 			float shade = l->_intensity;
 		
 			if (l->_type != Light::Ambient) {
@@ -356,12 +462,12 @@ void EMIModel::updateLighting(const Math::Matrix4 &modelToWorld) {
 				if (l->_type != Light::Direct) {
 					dir = l->_pos - vertex;
 					float distSq = dir.getSquareMagnitude();
-					if (distSq > l->_falloffFar * l->_falloffFar)
+					if (distSq > light.falloffFarSq)
 						continue;
 
 					dir.normalize();
 
-					if (distSq > l->_falloffNear * l->_falloffNear) {
+					if (distSq > light.falloffNearSq) {
 						float dist = sqrt(distSq);
 						float attn = 1.0f - (dist - l->_falloffNear) / (l->_falloffFar - l->_falloffNear);
 						shade *= attn;
@@ -370,27 +476,20 @@ void EMIModel::updateLighting(const Math::Matrix4 &modelToWorld) {
 
 				if (l->_type == Light::Spot) {
 					float cosAngle = l->_dir.dotProduct(dir);
-					if (cosAngle < 0.0f)
+					if (cosAngle < 0.0f || cosAngle < light.cosPenumbra)
 						continue;
 
-					float angle = acos(cosAngle);
-					if (angle > l->_penumbraangle)
-						continue;
-
-					if (angle > l->_umbraangle)
+					if (cosAngle < light.cosUmbra) {
+						float angle = acos(cosAngle);
 						shade *= 1.0f - (angle - l->_umbraangle) / (l->_penumbraangle - l->_umbraangle);
+					}
 				}
 
 				float dot = MAX(0.0f, normal.dotProduct(dir));
 				shade *= dot;
 			}
 
-			Math::Vector3d color;
-			color.x() = l->_color.getRed() / 255.0f;
-			color.y() = l->_color.getGreen() / 255.0f;
-			color.z() = l->_color.getBlue() / 255.0f;
-
-			result += color * shade;
+			result += light.color * shade;
 		}
 
 		if (!hasAmbient) {
@@ -448,6 +547,7 @@ EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *d
 	_boneInfos = nullptr;
 	_numBoneInfos = 0;
 	_vertexBoneInfo = nullptr;
+	_skinningMatrices = nullptr;
 	_skeleton = nullptr;
 	_radius = 0;
 	_center = new Math::Vector3d();
@@ -478,6 +578,7 @@ EMIModel::~EMIModel() {
 	delete[] _mats;
 	delete[] _boneInfos;
 	delete[] _vertexBoneInfo;
+	delete[] _skinningMatrices;
 	delete[] _boneNames;
 	delete[] _lighting;
 	delete[] _texFlags;
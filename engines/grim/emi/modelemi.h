@@ -114,6 +114,8 @@ public:
 	BoneInfo *_boneInfos;
 	Common::String *_boneNames;
 	int *_vertexBoneInfo;
+	// Per joint 3x4 matrices taking a vertex from the bind pose to the current pose.
+	float *_skinningMatrices;
 
 	// Stuff we dont know how to use:
 	float _radius;
@@ -128,6 +130,8 @@ public:
 
 	void *_userData;
 	bool _lightingDirty;
+	// The pose and the lights used for the last software lighting update.
+	Common::Array<float> _lightingKey;
 
 public:
 	EMIModel(const Common::String &filename, Common::SeekableReadStream *data, EMICostume *costume);
@@ -136,6 +140,7 @@ public:
 	void setSkeleton(Skeleton *skel);
 	void loadMesh(Common::SeekableReadStream *data);
 	void prepareForRender();
+	void updateSkinningMatrices();
 	void prepareTextures();
 	void draw();
 	void updateLighting(const Math::Matrix4 &modelToWorld);
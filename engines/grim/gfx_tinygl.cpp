@@ -22,6 +22,7 @@
 
 #include "common/config-manager.h"
 #include "common/endian.h"
+#include "common/hashmap.h"
 #include "common/system.h"
 
 #include "graphics/surface.h"
@@ -48,6 +49,20 @@ GfxBase *CreateGfxTinyGL() {
 	return new GfxTinyGL();
 }
 
+/**
+ * The faces of a mesh as indexed triangles. Every pair of vertex and texture vertex
+ * used by the faces gets its own vertex in the arrays, so that it is only transformed
+ * and lit once per draw.
+ */
+struct TinyGLMeshData {
+	Common::Array<float> _vertices;
+	Common::Array<float> _normals;
+	Common::Array<float> _texCoords;
+	Common::Array<uint32> _indices;
+	// The first index of every face, and the number of indices after the last one.
+	Common::Array<int> _faceStart;
+};
+
 GfxTinyGL::GfxTinyGL() :
 		_zb(nullptr), _alpha(1.f),
 		_currentActor(nullptr), _smushImage(nullptr) {
@@ -95,6 +110,8 @@ byte *GfxTinyGL::setupScreen(int screenW, int screenH, bool fullscreen) {
 	_zb = new TinyGL::FrameBuffer(screenW, screenH, buf);
 	TinyGL::glInit(_zb, 256);
 	tglEnableDirtyRects(ConfMan.getBool("dirtyrects"));
+	tglEnableTiledRendering(ConfMan.getBool("tiledrendering"));
+	tglEnableTextureFiltering(ConfMan.getBool("texturefiltering"));
 
 	_storedDisplay.create(_pixelFormat, _gameWidth * _gameHeight, DisposeAfterUse::YES);
 	_storedDisplay.clear(_gameWidth * _gameHeight);
@@ -631,34 +648,47 @@ void GfxTinyGL::drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face)
 	if (face->_flags & EMIMeshFace::kAlphaBlend || face->_flags & EMIMeshFace::kUnknownBlend || _currentActor->hasLocalAlpha() || _alpha < 1.0f)
 		tglEnable(TGL_BLEND);
 
-	tglBegin(TGL_TRIANGLES);
-	float alpha = _alpha;
-	if (model->_meshAlphaMode == Actor::AlphaReplace) {
-		alpha *= model->_meshAlpha;
-	}
-	Math::Vector3d noLighting(1.f, 1.f, 1.f);
-	for (uint j = 0; j < face->_faceLength * 3; j++) {
-		int index = indices[j];
+	tglEnableClientState(TGL_VERTEX_ARRAY);
+	tglEnableClientState(TGL_NORMAL_ARRAY);
+	tglVertexPointer(3, TGL_FLOAT, 0, model->_drawVertices);
+	tglNormalPointer(TGL_FLOAT, 0, model->_normals);
 
-		if (!_currentShadowArray) {
-			if (face->_hasTexture) {
-				tglTexCoord2f(model->_texVerts[index].getX(), model->_texVerts[index].getY());
-			}
+	if (!_currentShadowArray) {
+		float alpha = _alpha;
+		if (model->_meshAlphaMode == Actor::AlphaReplace) {
+			alpha *= model->_meshAlpha;
+		}
+		// The colors of the vertices depend on the face, so only those used by it are computed.
+		_emiVertexColors.resize(4 * model->_numVertices);
+		Math::Vector3d noLighting(1.f, 1.f, 1.f);
+		for (uint j = 0; j < face->_faceLength * 3; j++) {
+			int index = indices[j];
 			Math::Vector3d lighting = (face->_flags & EMIMeshFace::kNoLighting) ? noLighting : model->_lighting[index];
 			byte r = (byte)(model->_colorMap[index].r * lighting.x());
 			byte g = (byte)(model->_colorMap[index].g * lighting.y());
 			byte b = (byte)(model->_colorMap[index].b * lighting.z());
 			byte a = (int)(model->_colorMap[index].a * alpha * _currentActor->getLocalAlpha(index));
-			tglColor4ub(r, g, b, a);
+			float *color = &_emiVertexColors[4 * index];
+			color[0] = r / 255.0f;
+			color[1] = g / 255.0f;
+			color[2] = b / 255.0f;
+			color[3] = a / 255.0f;
 		}
 
-		Math::Vector3d normal = model->_normals[index];
-		Math::Vector3d vertex = model->_drawVertices[index];
-
-		tglNormal3fv(normal.getData());
-		tglVertex3fv(vertex.getData());
+		tglEnableClientState(TGL_COLOR_ARRAY);
+		tglColorPointer(4, TGL_FLOAT, 0, &_emiVertexColors[0]);
+		if (face->_hasTexture) {
+			tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+			tglTexCoordPointer(2, TGL_FLOAT, 0, model->_texVerts);
+		}
 	}
-	tglEnd();
+
+	tglDrawElements(TGL_TRIANGLES, face->_faceLength * 3, TGL_UNSIGNED_INT, indices);
+
+	tglDisableClientState(TGL_VERTEX_ARRAY);
+	tglDisableClientState(TGL_NORMAL_ARRAY);
+	tglDisableClientState(TGL_COLOR_ARRAY);
+	tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
 
 	if (!_currentShadowArray) {
 		tglColor3f(1.0f, 1.0f, 1.0f);
@@ -697,6 +727,58 @@ void GfxTinyGL::drawModelFace(const Mesh *mesh, const MeshFace *face) {
 	tglDisable(TGL_ALPHA_TEST);
 }
 
+void GfxTinyGL::drawMesh(const Mesh *mesh) {
+	const TinyGLMeshData *data = (const TinyGLMeshData *)mesh->_userData;
+	if (!data) {
+		GfxBase::drawMesh(mesh);
+		return;
+	}
+
+	tglEnableClientState(TGL_VERTEX_ARRAY);
+	tglEnableClientState(TGL_NORMAL_ARRAY);
+	tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+	tglVertexPointer(3, TGL_FLOAT, 0, &data->_vertices[0]);
+	tglNormalPointer(TGL_FLOAT, 0, &data->_normals[0]);
+	tglTexCoordPointer(2, TGL_FLOAT, 0, &data->_texCoords[0]);
+
+	// Support transparency in actor objects, such as the message tube
+	// in Manny's Office
+	tglAlphaFunc(TGL_GREATER, 0.5);
+	tglEnable(TGL_ALPHA_TEST);
+
+	// Faces are sorted by material, consecutive faces with the same material and
+	// lighting are drawn at once.
+	for (int i = 0; i < mesh->_numFaces;) {
+		const MeshFace *face = &mesh->_faces[i];
+		bool lightsOff = face->getLight() == 0 && !isShadowModeActive();
+
+		int end = i + 1;
+		while (end < mesh->_numFaces && mesh->_faces[end].getMaterial() == face->getMaterial() &&
+		       (mesh->_faces[end].getLight() == 0) == (face->getLight() == 0)) {
+			end++;
+		}
+
+		if (lightsOff)
+			disableLights();
+
+		face->getMaterial()->select();
+		int first = data->_faceStart[i];
+		tglDrawElements(TGL_TRIANGLES, data->_faceStart[end] - first, TGL_UNSIGNED_INT, &data->_indices[first]);
+
+		if (lightsOff)
+			enableLights();
+
+		i = end;
+	}
+
+	// Done with transparency-capable objects
+	tglDisable(TGL_ALPHA_TEST);
+
+	tglDisableClientState(TGL_VERTEX_ARRAY);
+	tglDisableClientState(TGL_NORMAL_ARRAY);
+	tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
+}
+
 void GfxTinyGL::drawSprite(const Sprite *sprite) {
 	tglMatrixMode(TGL_TEXTURE);
 	tglLoadIdentity();
@@ -1004,6 +1086,59 @@ void GfxTinyGL::destroyBitmap(BitmapData *bitmap) {
 	delete[] imgs;
 }
 
+void GfxTinyGL::createMesh(Mesh *mesh) {
+	TinyGLMeshData *data = new TinyGLMeshData();
+	Common::HashMap<uint32, int> vertexIds;
+	Common::Array<uint32> ids;
+
+	data->_faceStart.resize(mesh->_numFaces + 1);
+	for (int i = 0; i < mesh->_numFaces; ++i) {
+		const MeshFace *face = &mesh->_faces[i];
+		data->_faceStart[i] = data->_indices.size();
+
+		int numVertices = face->getNumVertices();
+		ids.resize(numVertices);
+		for (int j = 0; j < numVertices; ++j) {
+			int vert = face->getVertex(j);
+			int texVert = face->hasTexture() ? face->getTextureVertex(j) : -1;
+			uint32 key = vert * (mesh->_numTextureVerts + 1) + (texVert + 1);
+
+			Common::HashMap<uint32, int>::const_iterator it = vertexIds.find(key);
+			if (it != vertexIds.end()) {
+				ids[j] = it->_value;
+				continue;
+			}
+
+			ids[j] = data->_vertices.size() / 3;
+			vertexIds[key] = ids[j];
+			for (int k = 0; k < 3; ++k) {
+				data->_vertices.push_back(mesh->_vertices[3 * vert + k]);
+				data->_normals.push_back(mesh->_vertNormals[3 * vert + k]);
+			}
+			for (int k = 0; k < 2; ++k)
+				data->_texCoords.push_back(texVert >= 0 ? mesh->_textureVerts[2 * texVert + k] : 0.0f);
+		}
+
+		// Split the polygon into triangles the same way TGL_POLYGON does.
+		for (int j = numVertices; j >= 3; --j) {
+			data->_indices.push_back(ids[j - 1]);
+			data->_indices.push_back(ids[0]);
+			data->_indices.push_back(ids[j - 2]);
+		}
+	}
+	data->_faceStart[mesh->_numFaces] = data->_indices.size();
+
+	if (data->_indices.empty()) {
+		delete data;
+		data = nullptr;
+	}
+	mesh->_userData = data;
+}
+
+void GfxTinyGL::destroyMesh(const Mesh *mesh) {
+	delete (TinyGLMeshData *)mesh->_userData;
+}
+
 void GfxTinyGL::createFont(Font *font) {
 }
 
@@ -1181,7 +1316,7 @@ void GfxTinyGL::createTexture(Texture *texture, const uint8 *data, const CMap *c
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_REPEAT);
 
 	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_LINEAR);
-	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_LINEAR);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_LINEAR_MIPMAP_NEAREST);
 	tglTexImage2D(TGL_TEXTURE_2D, 0, 3, texture->_width, texture->_height, 0, format, TGL_UNSIGNED_BYTE, texdata);
 	delete[] texdata;
 }
@@ -80,6 +80,7 @@ public:
 
 	void drawEMIModelFace(const EMIModel *model, const EMIMeshFace *face) override;
 	void drawModelFace(const Mesh *mesh, const MeshFace *face) override;
+	void drawMesh(const Mesh *mesh) override;
 	void drawSprite(const Sprite *sprite) override;
 
 	void enableLights() override;
@@ -124,6 +125,9 @@ public:
 
 	void setBlendMode(bool additive) override;
 
+	void createMesh(Mesh *mesh) override;
+	void destroyMesh(const Mesh *mesh) override;
+
 protected:
 	void createSpecialtyTextureFromScreen(uint id, uint8 *data, int x, int y, int width, int height);
 
@@ -136,6 +140,7 @@ private:
 	float _alpha;
 	const Actor *_currentActor;
 	TGLenum _depthFunc;
+	Common::Array<float> _emiVertexColors;
 
 	void readPixels(int x, int y, int width, int height, uint8 *buffer);
 };
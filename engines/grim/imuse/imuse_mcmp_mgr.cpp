@@ -36,9 +36,15 @@ McmpMgr::McmpMgr() {
 	_numCompItems = 0;
 	_curSample = -1;
 	_compInput = nullptr;
-	_outputSize = 0;
+	_compInputSize = 0;
+	_firstInputBlock = 0;
+	_endInputBlock = 0;
 	_file = nullptr;
-	_lastBlock = -1;
+	_nextDecodedBlock = 0;
+	for (int i = 0; i < kDecodedBlocks; i++) {
+		_decodedBlocks[i].block = -1;
+		_decodedBlocks[i].size = 0;
+	}
 }
 
 McmpMgr::~McmpMgr() {
@@ -82,12 +88,63 @@ bool McmpMgr::openSound(const char *filename, Common::SeekableReadStream *data,
 	}
 	_file->seek(sizeCodecs, SEEK_CUR);
 	// hack: two more bytes at the end of input buffer
-	_compInput = new byte[maxSize + 2];
+	_compInputSize = MAX(maxSize, kReadAheadSize);
+	_compInput = new byte[_compInputSize + 2];
 	offsetData = headerSize;
 
 	return true;
 }
 
+void McmpMgr::readBlocks(int first) {
+	// The compressed blocks are contiguous, read as many as fit in the
+	// input buffer at once, to avoid seeking and reading for every block
+	int32 size = 0;
+	int end = first;
+	while (end < _numCompItems && size + _compTable[end].compSize <= _compInputSize) {
+		size += _compTable[end].compSize;
+		end++;
+	}
+	assert(end > first);
+
+	_file->seek(_compTable[first].offset, SEEK_SET);
+	_file->read(_compInput, size);
+	_firstInputBlock = first;
+	_endInputBlock = end;
+}
+
+const McmpMgr::DecodedBlock *McmpMgr::decodeBlock(int block) {
+	for (int i = 0; i < kDecodedBlocks; i++) {
+		if (_decodedBlocks[i].block == block)
+			return &_decodedBlocks[i];
+	}
+
+	if (block < _firstInputBlock || block >= _endInputBlock)
+		readBlocks(block);
+
+	// Replace the oldest decompressed block
+	DecodedBlock *decoded = &_decodedBlocks[_nextDecodedBlock];
+	_nextDecodedBlock = (_nextDecodedBlock + 1) % kDecodedBlocks;
+
+	decoded->size = _compTable[block].decompSize;
+	if (decoded->size > 0x2000) {
+		error("McmpMgr::decodeBlock() decompSize: %d", decoded->size);
+	}
+
+	// hack: two more zero bytes at the end of input buffer,
+	// restored afterwards since they can belong to the next block
+	byte *input = _compInput + (_compTable[block].offset - _compTable[_firstInputBlock].offset);
+	byte *inputEnd = input + _compTable[block].compSize;
+	byte next[2] = { inputEnd[0], inputEnd[1] };
+	inputEnd[0] = 0;
+	inputEnd[1] = 0;
+	decompressVima(input, (int16 *)decoded->data, decoded->size, imuseDestTable);
+	inputEnd[0] = next[0];
+	inputEnd[1] = next[1];
+
+	decoded->block = block;
+	return decoded;
+}
+
 int32 McmpMgr::decompressSample(int32 offset, int32 size, byte **comp_final) {
 	int32 i, final_size, output_size;
 	int skip, first_block, last_block;
@@ -105,26 +162,14 @@ int32 McmpMgr::decompressSample(int32 offset, int32 size, byte **comp_final) {
 	if ((last_block >= _numCompItems) && (_numCompItems > 0))
 		last_block = _numCompItems - 1;
 
-	int32 blocks_final_size = 0x2000 * (1 + last_block - first_block);
-	*comp_final = new byte[blocks_final_size];
+	// No more than size bytes are output, even when spanning several blocks
+	*comp_final = new byte[size];
 	final_size = 0;
 
 	for (i = first_block; i <= last_block; i++) {
-		if (_lastBlock != i) {
-			// hack: two more zero bytes at the end of input buffer
-			_compInput[_compTable[i].compSize] = 0;
-			_compInput[_compTable[i].compSize + 1] = 0;
-			_file->seek(_compTable[i].offset, SEEK_SET);
-			_file->read(_compInput, _compTable[i].compSize);
-			decompressVima(_compInput, (int16 *)_compOutput, _compTable[i].decompSize, imuseDestTable);
-			_outputSize = _compTable[i].decompSize;
-			if (_outputSize > 0x2000) {
-				error("McmpMgr::decompressSample() _outputSize: %d", _outputSize);
-			}
-			_lastBlock = i;
-		}
-
-		output_size = _outputSize - skip;
+		const DecodedBlock *decoded = decodeBlock(i);
+
+		output_size = decoded->size - skip;
 
 		if ((output_size + skip) > 0x2000) // workaround
 			output_size -= (output_size + skip) - 0x2000;
@@ -132,9 +177,7 @@ int32 McmpMgr::decompressSample(int32 offset, int32 size, byte **comp_final) {
 		if (output_size > size)
 			output_size = size;
 
-		assert(final_size + output_size <= blocks_final_size);
-
-		memcpy(*comp_final + final_size, _compOutput + skip, output_size);
+		memcpy(*comp_final + final_size, decoded->data + skip, output_size);
 		final_size += output_size;
 
 		size -= output_size;
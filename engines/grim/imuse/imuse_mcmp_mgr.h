@@ -35,14 +35,33 @@ private:
 		int32 offset;
 	};
 
+	/** A decompressed block */
+	struct DecodedBlock {
+		int block;
+		int size;
+		byte data[0x2000];
+	};
+
+	/** Number of decompressed blocks kept, so that region jumps can reuse them */
+	static const int kDecodedBlocks = 4;
+
+	/** Minimum size of the compressed data read at once */
+	static const int32 kReadAheadSize = 0x8000;
+
 	CompTable *_compTable;
 	int16 _numCompItems;
 	int _curSample;
 	Common::SeekableReadStream *_file;
-	byte _compOutput[0x2000];
+	DecodedBlock _decodedBlocks[kDecodedBlocks];
+	int _nextDecodedBlock;
+	/** Compressed data of the blocks _firstInputBlock to _endInputBlock excluded */
 	byte *_compInput;
-	int _outputSize;
-	int _lastBlock;
+	int32 _compInputSize;
+	int _firstInputBlock;
+	int _endInputBlock;
+
+	void readBlocks(int first);
+	const DecodedBlock *decodeBlock(int block);
 
 public:
 
@@ -21,8 +21,8 @@
  */
 
 #include "common/file.h"
-#include "common/substream.h"
 #include "common/memstream.h"
+#include "common/substream.h"
 
 #include "engines/grim/grim.h"
 #include "engines/grim/lab.h"
@@ -39,15 +39,20 @@ Common::SeekableReadStream *LabEntry::createReadStream() const {
 }
 
 Lab::Lab() {
-	_stream = nullptr;
+	_file = nullptr;
 }
 
 Lab::~Lab() {
-	delete _stream;
+	if (_file)
+		_file->decRef();
 }
 
 bool Lab::open(const Common::String &filename, bool keepStream) {
 	_labFileName = filename;
+	if (_file) {
+		_file->decRef();
+		_file = nullptr;
+	}
 
 	bool result = true;
 
@@ -66,9 +71,13 @@ bool Lab::open(const Common::String &filename, bool keepStream) {
 		file->seek(0, SEEK_SET);
 		byte *data = static_cast<byte*>(malloc(sizeof(byte) * file->size()));
 		file->read(data, file->size());
-		_stream = new Common::MemoryReadStream(data, file->size(), DisposeAfterUse::YES);
+		_file = new Common::LockedSeekableReadStream(new Common::MemoryReadStream(data, file->size(), DisposeAfterUse::YES));
+		delete file;
+	} else if (result) {
+		_file = new Common::LockedSeekableReadStream(file);
+	} else {
+		delete file;
 	}
-	delete file;
 
 	return result;
 }
@@ -180,16 +189,7 @@ Common::SeekableReadStream *Lab::createReadStreamForMember(const Common::String
 	fname.toLowercase();
 	LabEntryPtr i = _entries[fname];
 
-	if (!_stream) {
-		Common::File *file = new Common::File();
-		file->open(_labFileName);
-		return new Common::SeekableSubReadStream(file, i->_offset, i->_offset + i->_len, DisposeAfterUse::YES);
-	} else {
-		byte *data = static_cast<byte*>(malloc(sizeof(byte) * i->_len));
-		_stream->seek(i->_offset, SEEK_SET);
-		_stream->read(data, i->_len);
-		return new Common::MemoryReadStream(data, i->_len, DisposeAfterUse::YES);
-	}
+	return new Common::LockedSeekableSubReadStream(_file, i->_offset, i->_offset + i->_len);
 }
 
 } // end of namespace Grim
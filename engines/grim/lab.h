@@ -27,6 +27,7 @@
 
 namespace Common {
 	class File;
+	class LockedSeekableReadStream;
 }
 
 namespace Grim {
@@ -63,7 +64,8 @@ private:
 	typedef Common::SharedPtr<LabEntry> LabEntryPtr;
 	typedef Common::HashMap<Common::String, LabEntryPtr, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> LabMap;
 	LabMap _entries;
-	Common::SeekableReadStream *_stream;
+	// The open archive. The streams of its members hold their own reference to it.
+	Common::LockedSeekableReadStream *_file;
 };
 
 } // end of namespace Grim
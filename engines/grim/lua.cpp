@@ -261,11 +261,14 @@ void LuaBase::boot() {
 }
 
 void LuaBase::update(int frameTime, int movieTime) {
+	// Start a collection cycle every 10 seconds, and run a step of it every frame
 	_frameTimeCollection += frameTime;
+	bool startCollection = false;
 	if (_frameTimeCollection > 10000) {
 		_frameTimeCollection = 0;
-		lua_collectgarbage(0);
+		startCollection = true;
 	}
+	lua_stepgarbage(startCollection);
 
 	lua_beginblock();
 	setFrameTime(frameTime);
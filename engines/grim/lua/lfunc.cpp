@@ -7,6 +7,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_longjmp
 
 #include "engines/grim/lua/lfunc.h"
+#include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/lmem.h"
 #include "engines/grim/lua/lstate.h"
 
@@ -20,6 +21,7 @@ namespace Grim {
 Closure *luaF_newclosure(int32 nelems) {
 	Closure *c = (Closure *)luaM_malloc(sizeof(Closure) + nelems * sizeof(TObject));
 	luaO_insertlist(&rootcl, (GCnode *)c);
+	luaC_newobject((GCnode *)c, LUA_T_CLOSURE);
 	nblocks += gcsizeclosure(c);
 	c->nelems = nelems;
 	return c;
@@ -34,6 +36,7 @@ TProtoFunc *luaF_newproto() {
 	f->nconsts = 0;
 	f->locvars = nullptr;
 	luaO_insertlist(&rootproto, (GCnode *)f);
+	luaC_newobject((GCnode *)f, LUA_T_PROTO);
 	nblocks += gcsizeproto(f);
 	return f;
 }
@@ -129,20 +129,55 @@ void luaC_strcallIM(TaggedString *l) {
 	}
 }
 
-static GCnode *listcollect(GCnode *l) {
-	GCnode *frees = nullptr;
-	while (l) {
-		GCnode *next = l->next;
-		l->marked = 0;
-		while (next && !next->marked) {
-			l->next = next->next;
-			next->next = frees;
-			frees = next;
-			next = l->next;
-		}
-		l = next;
-	}
-	return frees;
+/*
+** =======================================================
+** Incremental collection
+** =======================================================
+*/
+
+// A collection cycle marks the reachable objects in small steps. The marked
+// objects whose references were not traversed yet are gray, and wait in
+// graystack. Once it is empty, the roots are marked again in one go, since the
+// stacks, the globals and the refs change without any barrier. The objects are
+// then swept in small steps as well.
+// Tables are the only objects changed after their creation, so luaH_set makes
+// a black table gray again (see luaC_barrier). The objects created while
+// marking are gray, the ones created while sweeping are left out of the sweep.
+
+#define GCSTEPWORK		2000  // work done by a step, in traversed slots or swept objects
+#define GCSTEPBLOCKS	100  // blocks allocated between two steps of a cycle
+
+int32 GCstate = GCSpause;
+
+static TObject *graystack = nullptr;
+static int32 graysize = 0;
+static int32 graytop = 0;
+
+// A list being swept. Its objects were moved out of the root list, so that
+// the objects created meanwhile are not swept, and the surviving ones are
+// moved back to the end of the root list.
+struct SweepList {
+	GCnode *tail;
+	GCnode *next;
+};
+
+static SweepList sweeplists[3];
+static int32 sweepstring;  // next string table to sweep
+static int32 sweeplist;  // list being swept
+static bool gcrunning = false;  // to avoid GC during GC
+
+static void pushgray(GCnode *head, Value v, lua_Type t) {
+	head->marked = GCGRAY;
+	if (graytop == graysize)
+		graysize = luaM_growvector(&graystack, graysize, TObject, memEM, MAX_INT);
+	graystack[graytop].ttype = t;
+	graystack[graytop].value = v;
+	graytop++;
+}
+
+static void graymark(GCnode *head, TObject *o, lua_Type t) {
+	if (head->marked == GCWHITE)
+		pushgray(head, o->value, t);
 }
 
 static void strmark(TaggedString *s) {
@@ -150,45 +185,39 @@ static void strmark(TaggedString *s) {
 		s->head.marked = 1;
 }
 
-static void protomark(TProtoFunc *f) {
-	if (!f->head.marked) {
-		LocVar *v = f->locvars;
-		int32 i;
-		f->head.marked = 1;
-		if (f->fileName)
-			strmark(f->fileName);
-		for (i = 0; i < f->nconsts; i++)
-			markobject(&f->consts[i]);
-		if (v) {
-			for (; v->line != -1; v++) {
-				if (v->varname)
-					strmark(v->varname);
-			}
+static int32 protomark(TProtoFunc *f) {
+	LocVar *v = f->locvars;
+	int32 i;
+	if (f->fileName)
+		strmark(f->fileName);
+	for (i = 0; i < f->nconsts; i++)
+		markobject(&f->consts[i]);
+	if (v) {
+		for (; v->line != -1; v++) {
+			if (v->varname)
+				strmark(v->varname);
 		}
 	}
+	return f->nconsts + 1;
 }
 
-static void closuremark(Closure *f) {
-	if (!f->head.marked) {
-		int32 i;
-		f->head.marked = 1;
-		for (i = f->nelems; i >= 0; i--)
-			markobject(&f->consts[i]);
-	}
+static int32 closuremark(Closure *f) {
+	int32 i;
+	for (i = f->nelems; i >= 0; i--)
+		markobject(&f->consts[i]);
+	return f->nelems + 1;
 }
 
-static void hashmark(Hash *h) {
-	if (!h->head.marked) {
-		int32 i;
-		h->head.marked = 1;
-		for (i = 0; i < nhash(h); i++) {
-			Node *n = node(h, i);
-			if (ttype(ref(n)) != LUA_T_NIL) {
-				markobject(&n->ref);
-				markobject(&n->val);
-			}
+static int32 hashmark(Hash *h) {
+	int32 i;
+	for (i = 0; i < nhash(h); i++) {
+		Node *n = node(h, i);
+		if (ttype(ref(n)) != LUA_T_NIL) {
+			markobject(&n->ref);
+			markobject(&n->val);
 		}
 	}
+	return nhash(h) + 1;
 }
 
 static void globalmark() {
@@ -207,15 +236,15 @@ static int32 markobject(TObject *o) {
 		strmark(tsvalue(o));
 		break;
 	case LUA_T_ARRAY:
-		hashmark(avalue(o));
+		graymark(&avalue(o)->head, o, LUA_T_ARRAY);
 		break;
 	case LUA_T_CLOSURE:
 	case LUA_T_CLMARK:
-		closuremark(o->value.cl);
+		graymark(&o->value.cl->head, o, LUA_T_CLOSURE);
 		break;
 	case LUA_T_PROTO:
 	case LUA_T_PMARK:
-		protomark(o->value.tf);
+		graymark(&o->value.tf->head, o, LUA_T_PROTO);
 		break;
 	default:
 		break;  // numbers, cprotos, etc
@@ -230,34 +259,203 @@ static void markall() {
 	luaT_travtagmethods(markobject);  // mark fallbacks
 }
 
-int32 lua_collectgarbage(int32 limit) {
-	int32 recovered = nblocks;  // to subtract nblocks after gc
-	Hash *freetable;
-	TaggedString *freestr;
-	TProtoFunc *freefunc;
-	Closure *freeclos;
+// Traverses the last gray object, and returns the work done
+static int32 propagatemark() {
+	TObject *o = &graystack[--graytop];
+	switch (ttype(o)) {
+	case LUA_T_ARRAY:
+		avalue(o)->head.marked = GCBLACK;
+		return hashmark(avalue(o));
+	case LUA_T_CLOSURE:
+		o->value.cl->head.marked = GCBLACK;
+		return closuremark(o->value.cl);
+	case LUA_T_PROTO:
+		o->value.tf->head.marked = GCBLACK;
+		return protomark(o->value.tf);
+	default:
+		return 1;
+	}
+}
+
+static void startsweep(SweepList *l, GCnode *root) {
+	l->tail = root;
+	l->next = root->next;
+	root->next = nullptr;
+}
+
+static void endsweep(SweepList *l) {
+	while (l->tail->next)
+		l->tail = l->tail->next;
+	l->tail->next = l->next;
+	l->next = nullptr;
+}
+
+static void atomic() {
 	markall();
+	while (graytop > 0)
+		propagatemark();
 	invalidaterefs();
-	freestr = luaS_collector();
-	freetable = (Hash *)listcollect(&roottable);
-	freefunc = (TProtoFunc *)listcollect(&rootproto);
-	freeclos = (Closure *)listcollect(&rootcl);
-	GCthreshold *= 4;  // to avoid GC during GC
-	luaC_hashcallIM(freetable);  // GC tag methods for tables
+	luaS_collectglobals();
+	startsweep(&sweeplists[0], &roottable);
+	startsweep(&sweeplists[1], &rootproto);
+	startsweep(&sweeplists[2], &rootcl);
+	sweepstring = 0;
+	sweeplist = 0;
+	GCstate = GCSsweepstring;
+}
+
+// Sweeps objects of the list, and returns the work done
+static int32 sweepobjects(SweepList *l, GCnode **frees, int32 work) {
+	int32 done = 0;
+	while (l->next && done < work) {
+		GCnode *o = l->next;
+		l->next = o->next;
+		if (o->marked) {
+			o->marked = GCWHITE;
+			// append it after the objects created meanwhile
+			while (l->tail->next)
+				l->tail = l->tail->next;
+			l->tail->next = o;
+			o->next = nullptr;
+			l->tail = o;
+		} else {
+			o->next = *frees;
+			*frees = o;
+		}
+		done++;
+	}
+	return done;
+}
+
+// Does 'work' of the collection cycle, starting a new one if needed. Returns
+// whether the cycle is over.
+static bool collectstep(int32 work) {
+	GCnode *frees[3] = { nullptr, nullptr, nullptr };  // tables, protos and closures
+	TaggedString *freestr = nullptr;
+
+	gcrunning = true;
+	if (GCstate == GCSpause) {
+		markall();
+		GCstate = GCSpropagate;
+	}
+	while (work > 0 && GCstate != GCSpause) {
+		switch (GCstate) {
+		case GCSpropagate:
+			if (graytop > 0)
+				work -= propagatemark();
+			else
+				atomic();
+			break;
+		case GCSsweepstring:
+			if (sweepstring < NUM_HASHS) {
+				TaggedString *l = luaS_collector(sweepstring);
+				work -= string_root[sweepstring].size + 1;
+				sweepstring++;
+				while (l) {
+					TaggedString *next = (TaggedString *)l->head.next;
+					l->head.next = (GCnode *)freestr;
+					freestr = l;
+					l = next;
+				}
+			} else
+				GCstate = GCSsweep;
+			break;
+		case GCSsweep:
+			if (sweeplist < 3) {
+				SweepList *l = &sweeplists[sweeplist];
+				work -= sweepobjects(l, &frees[sweeplist], work);
+				if (!l->next)
+					sweeplist++;
+			} else
+				GCstate = GCSpause;
+			break;
+		default:
+			break;
+		}
+	}
+	luaC_hashcallIM((Hash *)frees[0]);  // GC tag methods for tables
 	luaC_strcallIM(freestr);  // GC tag methods for userdata
-	luaD_gcIM(&luaO_nilobject);  // GC tag method for nil (signal end of GC)
-	luaH_free(freetable);
+	if (GCstate == GCSpause)
+		luaD_gcIM(&luaO_nilobject);  // GC tag method for nil (signal end of GC)
+	luaH_free((Hash *)frees[0]);
 	luaS_free(freestr);
-	luaF_freeproto(freefunc);
-	luaF_freeclosure(freeclos);
+	luaF_freeproto((TProtoFunc *)frees[1]);
+	luaF_freeclosure((Closure *)frees[2]);
+	gcrunning = false;
+	return GCstate == GCSpause;
+}
+
+static void stepcollection() {
+	if (gcrunning)
+		return;
+	if (collectstep(GCSTEPWORK))
+		GCthreshold = 2 * nblocks;
+	else
+		GCthreshold = nblocks + GCSTEPBLOCKS;
+}
+
+void luaC_newobject(GCnode *o, lua_Type t) {
+	// an object created while marking is traversed once built
+	if (GCstate == GCSpropagate) {
+		Value v;
+		switch (t) {
+		case LUA_T_ARRAY:
+			v.a = (Hash *)o;
+			break;
+		case LUA_T_CLOSURE:
+			v.cl = (Closure *)o;
+			break;
+		default:
+			v.tf = (TProtoFunc *)o;
+			break;
+		}
+		pushgray(o, v, t);
+	}
+}
+
+void luaC_barrierback(Hash *h) {
+	// traverse the table again, with the value being set
+	Value v;
+	v.a = h;
+	pushgray(&h->head, v, LUA_T_ARRAY);
+}
+
+void luaC_resetgc() {
+	int32 i;
+	if (GCstate == GCSsweepstring || GCstate == GCSsweep) {
+		for (i = 0; i < 3; i++)
+			endsweep(&sweeplists[i]);
+	}
+	luaM_free(graystack);
+	graystack = nullptr;
+	graysize = 0;
+	graytop = 0;
+	GCstate = GCSpause;
+	gcrunning = false;
+}
+
+int32 lua_collectgarbage(int32 limit) {
+	int32 recovered;
+	if (gcrunning)
+		return 0;
+	// finish the running cycle, which may have missed the latest garbage
+	if (GCstate != GCSpause)
+		collectstep(MAX_INT);
+	recovered = nblocks;  // to subtract nblocks after gc
+	collectstep(MAX_INT);
 	recovered = recovered - nblocks;
 	GCthreshold = (limit == 0) ? 2 * nblocks : nblocks + limit;
 	return recovered;
 }
 
+void lua_stepgarbage(bool start) {
+	if (start || GCstate != GCSpause || nblocks >= GCthreshold)
+		stepcollection();
+}
+
 void luaC_checkGC() {
 	if (nblocks >= GCthreshold)
-		lua_collectgarbage(0);
+		stepcollection();
 }
 
 } // end of namespace Grim
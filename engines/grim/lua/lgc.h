@@ -11,12 +11,38 @@
 
 namespace Grim {
 
+// Marks of the tables, closures and protos. The strings are never gray,
+// their mark 2 means they are fixed instead.
+#define GCWHITE	0
+#define GCBLACK	1
+#define GCGRAY	2
+
+// States of the incremental collector
+enum {
+	GCSpause,
+	GCSpropagate,
+	GCSsweepstring,
+	GCSsweep
+};
+
+extern int32 GCstate;
+
 void luaC_checkGC();
+void luaC_newobject(GCnode *o, lua_Type t);
+void luaC_barrierback(Hash *h);
+void luaC_resetgc();
 TObject* luaC_getref(int32 r);
 int32 luaC_ref(TObject *o, int32 lock);
 void luaC_hashcallIM(Hash *l);
 void luaC_strcallIM(TaggedString *l);
 
+// To be called before changing a table, so that a table already traversed
+// by the running collection is traversed again.
+inline void luaC_barrier(Hash *h) {
+	if (GCstate == GCSpropagate && h->head.marked == GCBLACK)
+		luaC_barrierback(h);
+}
+
 } // end of namespace Grim
 
 #endif
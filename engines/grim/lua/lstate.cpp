@@ -211,6 +211,7 @@ void lua_open() {
 }
 
 void lua_close() {
+	luaC_resetgc();
 	TaggedString *alludata = luaS_collectudata();
 	GCthreshold = MAX_INT;  // to avoid GC during GC
 	luaC_hashcallIM((Hash *)roottable.next);  // GC t.methods for tables
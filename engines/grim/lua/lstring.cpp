@@ -8,6 +8,7 @@
 
 #include "common/util.h"
 
+#include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/lmem.h"
 #include "engines/grim/lua/lobject.h"
 #include "engines/grim/lua/lstate.h"
@@ -91,6 +92,14 @@ static TaggedString *newone(const char *buff, int32 tag, uint32 h) {
 	return ts;
 }
 
+// While a collection is running, a string may be dead without being swept
+// yet: keep the strings being used
+static TaggedString *keepstring(TaggedString *ts) {
+	if (GCstate != GCSpause && ts->head.marked == 0)
+		ts->head.marked = 1;
+	return ts;
+}
+
 static TaggedString *insert(const char *buff, int32 tag, stringtable *tb) {
 	TaggedString *ts;
 	uint32 h = hash(buff, tag);
@@ -107,7 +116,7 @@ static TaggedString *insert(const char *buff, int32 tag, stringtable *tb) {
 		else if ((ts->constindex >= 0) ? // is a string?
 				(tag == LUA_T_STRING && (strcmp(buff, ts->str) == 0)) :
 				((tag == ts->globalval.ttype || tag == LUA_ANYTAG) && buff == (const char *)ts->globalval.value.ts))
-			return ts;
+			return keepstring(ts);
 		if (++i == size)
 			i = 0;
 	}
@@ -117,7 +126,7 @@ static TaggedString *insert(const char *buff, int32 tag, stringtable *tb) {
 	else
 		tb->nuse++;
 	ts = tb->hash[i] = newone(buff, tag, h);
-	return ts;
+	return keepstring(ts);
 }
 
 TaggedString *luaS_createudata(void *udata, int32 tag) {
@@ -138,7 +147,7 @@ TaggedString *luaS_new(const char *str) {
 
 TaggedString *luaS_newfixedstring(const char *str) {
 	TaggedString *ts = luaS_new(str);
-	if (ts->head.marked == 0)
+	if (ts->head.marked <= 1)
 		ts->head.marked = 2;  // avoid GC
 	return ts;
 }
@@ -159,30 +168,33 @@ void luaS_free(TaggedString *l) {
 static void remove_from_list(GCnode *l) {
 	while (l) {
 		GCnode *next = l->next;
-		while (next && !next->marked)
+		while (next && !next->marked) {
+			GCnode *removed = next;
 			next = l->next = next->next;
+			removed->next = removed;  // signal it is in no list
+		}
 		l = next;
 	}
 }
 
-TaggedString *luaS_collector() {
-	TaggedString *frees = nullptr;
-	int32 i;
+void luaS_collectglobals() {
 	remove_from_list(&rootglobal);
-	for (i = 0; i < NUM_HASHS; i++) {
-		stringtable *tb = &string_root[i];
-		int32 j;
-		for (j = 0; j < tb->size; j++) {
-			TaggedString *t = tb->hash[j];
-			if (!t)
-				continue;
-			if (t->head.marked == 1)
-				t->head.marked = 0;
-			else if (!t->head.marked) {
-				t->head.next = (GCnode *)frees;
-				frees = t;
-				tb->hash[j] = &EMPTY;
-			}
+}
+
+TaggedString *luaS_collector(int32 i) {
+	TaggedString *frees = nullptr;
+	stringtable *tb = &string_root[i];
+	int32 j;
+	for (j = 0; j < tb->size; j++) {
+		TaggedString *t = tb->hash[j];
+		if (!t)
+			continue;
+		if (t->head.marked == 1)
+			t->head.marked = 0;
+		else if (!t->head.marked) {
+			t->head.next = (GCnode *)frees;
+			frees = t;
+			tb->hash[j] = &EMPTY;
 		}
 	}
 	return frees;
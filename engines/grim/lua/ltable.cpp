@@ -7,6 +7,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_longjmp
 
 #include "engines/grim/lua/lauxlib.h"
+#include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/lmem.h"
 #include "engines/grim/lua/lobject.h"
 #include "engines/grim/lua/lstate.h"
@@ -166,6 +167,7 @@ Hash *luaH_new(int32 nhash) {
 	nuse(t) = 0;
 	t->htag = TagDefault;
 	luaO_insertlist(&roottable, (GCnode *)t);
+	luaC_newobject((GCnode *)t, LUA_T_ARRAY);
 	nblocks += gcsize(nhash);
 	return t;
 }
@@ -220,6 +222,7 @@ TObject *luaH_get(Hash *t, TObject *r) {
 */
 TObject *luaH_set(Hash *t, TObject *r) {
 	Node *n = node(t, present(t, r));
+	luaC_barrier(t);
 	if (ttype(ref(n)) == LUA_T_NIL) {
 		nuse(t)++;
 		if ((float)nuse(t) > (float)nhash(t) * REHASH_LIMIT) {
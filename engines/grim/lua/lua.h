@@ -130,6 +130,7 @@ void lua_unref(int32 ref);
 
 lua_Object lua_createtable();
 int32 lua_collectgarbage(int32 limit);
+void lua_stepgarbage(bool start); // runs a step of the incremental collector
 
 void lua_runtasks();
 void current_script();
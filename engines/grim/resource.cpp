@@ -71,10 +71,39 @@ public:
 	}
 };
 
+/**
+ * A stream reading the data of a cache entry, which stays pinned while the stream exists.
+ */
+class CachedResourceStream : public Common::MemoryReadStream {
+public:
+	CachedResourceStream(ResourceLoader::ResourceCache *entry) :
+		Common::MemoryReadStream(entry->resPtr, entry->len), _entry(entry) {
+		_entry->incRef();
+	}
+
+	~CachedResourceStream() {
+		_entry->decRef();
+	}
+
+private:
+	ResourceLoader::ResourceCache *_entry;
+};
+
+void ResourceLoader::ResourceCache::decRef() {
+	if (--refCount == 0) {
+		delete[] resPtr;
+		delete this;
+	}
+}
+
 ResourceLoader::ResourceLoader() {
-	_cacheDirty = false;
 	_cacheMemorySize = 0;
 
+	// Maximum size of the file cache, in megabytes. Entries still read by a stream
+	// are kept even if this is exceeded.
+	ConfMan.registerDefault("resource_cache_size", 32);
+	_cacheMaxMemorySize = ConfMan.getInt("resource_cache_size") * 1024 * 1024;
+
 	Lab *l;
 	Common::ArchiveMemberList files, updFiles;
 
@@ -221,10 +250,8 @@ void clearList(Common::List<T> &list) {
 }
 
 ResourceLoader::~ResourceLoader() {
-	for (Common::Array<ResourceCache>::iterator i = _cache.begin(); i != _cache.end(); ++i) {
-		ResourceCache &r = *i;
-		delete[] r.fname;
-		delete[] r.resPtr;
+	for (CacheMap::iterator i = _cache.begin(); i != _cache.end(); ++i) {
+		i->_value->decRef();
 	}
 	clearList(_models);
 	clearList(_colormaps);
@@ -233,32 +260,24 @@ ResourceLoader::~ResourceLoader() {
 	MD5Check::clear();
 }
 
-static int sortCallback(const void *entry1, const void *entry2) {
-	return scumm_stricmp(((const ResourceLoader::ResourceCache *)entry1)->fname, ((const ResourceLoader::ResourceCache *)entry2)->fname);
-}
-
 Common::SeekableReadStream *ResourceLoader::getFileFromCache(const Common::String &filename) const {
 	ResourceLoader::ResourceCache *entry = getEntryFromCache(filename);
 	if (!entry)
 		return nullptr;
 
-	return new Common::MemoryReadStream(entry->resPtr, entry->len);
-
+	// Move the entry to the most recently used end
+	_cacheLRU.erase(entry->lruPos);
+	_cacheLRU.push_back(entry);
+	entry->lruPos = _cacheLRU.reverse_begin();
+	return new CachedResourceStream(entry);
 }
 
 ResourceLoader::ResourceCache *ResourceLoader::getEntryFromCache(const Common::String &filename) const {
-	if (_cache.empty())
+	CacheMap::const_iterator i = _cache.find(filename);
+	if (i == _cache.end())
 		return nullptr;
 
-	if (_cacheDirty) {
-		qsort(_cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
-		_cacheDirty = false;
-	}
-
-	ResourceCache key;
-	key.fname = const_cast<char *>(filename.c_str());
-
-	return (ResourceLoader::ResourceCache *)bsearch(&key, _cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
+	return i->_value;
 }
 
 Common::SeekableReadStream *ResourceLoader::loadFile(const Common::String &filename) const {
@@ -286,9 +305,9 @@ Common::SeekableReadStream *ResourceLoader::openNewStreamFile(Common::String fna
 			uint32 size = s->size();
 			byte *buf = new byte[size];
 			s->read(buf, size);
-			putIntoCache(fname, buf, size);
+			ResourceCache *entry = putIntoCache(fname, buf, size);
 			delete s;
-			s = new Common::MemoryReadStream(buf, size);
+			s = new CachedResourceStream(entry);
 		}
 	} else {
 		s = loadFile(fname);
@@ -297,15 +316,34 @@ Common::SeekableReadStream *ResourceLoader::openNewStreamFile(Common::String fna
 	return Common::wrapCompressedReadStream(s);
 }
 
-void ResourceLoader::putIntoCache(const Common::String &fname, byte *res, uint32 len) const {
-	ResourceCache entry;
-	entry.resPtr = res;
-	entry.len = len;
-	entry.fname = new char[fname.size() + 1];
-	strcpy(entry.fname, fname.c_str());
+ResourceLoader::ResourceCache *ResourceLoader::putIntoCache(const Common::String &fname, byte *res, uint32 len) const {
+	ResourceCache *entry = new ResourceCache();
+	entry->fname = fname;
+	entry->resPtr = res;
+	entry->len = len;
+	entry->refCount = 1;
 	_cacheMemorySize += len;
-	_cache.push_back(entry);
-	_cacheDirty = true;
+	_cache[fname] = entry;
+	_cacheLRU.push_back(entry);
+	entry->lruPos = _cacheLRU.reverse_begin();
+
+	evictFromCache(entry);
+	return entry;
+}
+
+void ResourceLoader::evictFromCache(const ResourceCache *keep) const {
+	// Drop the least recently used entries until the cache fits in its budget again.
+	// Pinned entries can not be dropped, so the cache may stay over budget for a while.
+	Common::List<ResourceCache *>::iterator i = _cacheLRU.begin();
+	while (_cacheMemorySize > _cacheMaxMemorySize && i != _cacheLRU.end()) {
+		ResourceCache *entry = *i;
+		++i;
+		if (entry == keep || entry->isPinned())
+			continue;
+
+		Debug::debug(Debug::Engine, "Evicting %s from the resource cache", entry->fname.c_str());
+		uncache(entry->fname.c_str());
+	}
 }
 
 CMap *ResourceLoader::loadColormap(const Common::String &filename) {
@@ -516,23 +554,15 @@ AnimationEmi *ResourceLoader::loadAnimationEmi(const Common::String &filename) {
 }
 
 void ResourceLoader::uncache(const char *filename) const {
-	Common::String fname = filename;
-	fname.toLowercase();
-
-	if (_cacheDirty) {
-		qsort(_cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
-		_cacheDirty = false;
-	}
-
-	for (unsigned int i = 0; i < _cache.size(); i++) {
-		if (fname.compareTo(_cache[i].fname) == 0) {
-			delete[] _cache[i].fname;
-			_cacheMemorySize -= _cache[i].len;
-			delete[] _cache[i].resPtr;
-			_cache.remove_at(i);
-			_cacheDirty = true;
-		}
-	}
+	CacheMap::iterator i = _cache.find(filename);
+	if (i == _cache.end())
+		return;
+
+	ResourceCache *entry = i->_value;
+	_cache.erase(i);
+	_cacheLRU.erase(entry->lruPos);
+	_cacheMemorySize -= entry->len;
+	entry->decRef();
 }
 
 void ResourceLoader::uncacheModel(Model *m) {
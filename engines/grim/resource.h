@@ -25,6 +25,8 @@
 
 #include "common/archive.h"
 #include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 
 #include "engines/grim/object.h"
 
@@ -84,10 +86,22 @@ public:
 	void uncacheLipSync(LipSync *l);
 	void uncacheAnimationEmi(AnimationEmi *a);
 
+	/**
+	 * The data of a file read through the cache.
+	 * The cache holds one reference to it, and every stream reading the data holds
+	 * another one: the entry is pinned while streams use it and is only freed once
+	 * it has been evicted and the last stream is gone.
+	 */
 	struct ResourceCache {
-		char *fname;
+		Common::String fname;
 		byte *resPtr;
 		uint32 len;
+		Common::List<ResourceCache *>::iterator lruPos;  // position in _cacheLRU
+		int refCount;
+
+		bool isPinned() const { return refCount > 1; }
+		void incRef() { ++refCount; }
+		void decRef();
 	};
 
 	static Common::String fixFilename(const Common::String &filename, bool append = true);
@@ -96,12 +110,15 @@ private:
 	Common::SeekableReadStream *loadFile(const Common::String &filename) const;
 	Common::SeekableReadStream *getFileFromCache(const Common::String &filename) const;
 	ResourceLoader::ResourceCache *getEntryFromCache(const Common::String &filename) const;
-	void putIntoCache(const Common::String &fname, byte *res, uint32 len) const;
+	ResourceLoader::ResourceCache *putIntoCache(const Common::String &fname, byte *res, uint32 len) const;
 	void uncache(const char *fname) const;
+	void evictFromCache(const ResourceCache *keep) const;
 
-	mutable Common::Array<ResourceCache> _cache;
-	mutable bool _cacheDirty;
+	typedef Common::HashMap<Common::String, ResourceCache *, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> CacheMap;
+	mutable CacheMap _cache;
+	mutable Common::List<ResourceCache *> _cacheLRU;  // least recently used entry first
 	mutable int32 _cacheMemorySize;
+	int32 _cacheMaxMemorySize;
 
 	Common::List<EMIModel *> _emiModels;
 	Common::List<Model *> _models;
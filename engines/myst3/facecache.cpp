@@ -0,0 +1,206 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/myst3/facecache.h"
+#include "engines/myst3/database.h"
+#include "engines/myst3/directorysubentry.h"
+#include "engines/myst3/myst3.h"
+#include "engines/myst3/state.h"
+
+#include "common/debug.h"
+
+#include "graphics/surface.h"
+
+namespace Myst3 {
+
+FaceCache::FaceCache(Myst3Engine *vm) :
+		_vm(vm) {
+}
+
+FaceCache::~FaceCache() {
+	clear();
+}
+
+void FaceCache::clear() {
+	for (Common::List<Entry>::iterator it = _entries.begin(); it != _entries.end(); it++) {
+		it->bitmap->free();
+		delete it->bitmap;
+	}
+
+	_entries.clear();
+	_prefetchQueue.clear();
+}
+
+Common::String FaceCache::getCurrentRoomName() const {
+	return _vm->_db->getRoomName(_vm->_state->getLocationRoom(), _vm->_state->getLocationAge());
+}
+
+Common::List<FaceCache::Entry>::iterator FaceCache::find(const Common::String &room, uint16 node, uint16 face) {
+	Common::List<Entry>::iterator it = _entries.begin();
+	while (it != _entries.end()) {
+		if (it->node == node && it->face == face && it->room == room)
+			break;
+		it++;
+	}
+
+	return it;
+}
+
+Graphics::Surface *FaceCache::decode(const Common::String &room, uint16 node, uint16 face) {
+	const DirectorySubEntry *jpegDesc = _vm->getFileDescription(room, node, face, DirectorySubEntry::kCubeFace);
+	if (!jpegDesc)
+		return 0;
+
+	return Myst3Engine::decodeJpeg(jpegDesc);
+}
+
+void FaceCache::insert(const Common::String &room, uint16 node, uint16 face, Graphics::Surface *bitmap) {
+	Entry entry;
+	entry.room = room;
+	entry.node = node;
+	entry.face = face;
+	entry.bitmap = bitmap;
+	_entries.push_front(entry);
+
+	// Evict the least recently used faces
+	while (_entries.size() > kMaxFaces) {
+		Entry &last = _entries.back();
+		last.bitmap->free();
+		delete last.bitmap;
+		_entries.pop_back();
+	}
+}
+
+Graphics::Surface *FaceCache::getCubeFace(uint16 node, uint16 face) {
+	Common::String room = getCurrentRoomName();
+
+	// The faces can be drawn on, so they are not shared with the cache
+	Common::List<Entry>::iterator it = find(room, node, face);
+	if (it != _entries.end()) {
+		// Move the face to the front of the list
+		Entry entry = *it;
+		_entries.erase(it);
+		_entries.push_front(entry);
+
+		Graphics::Surface *copy = new Graphics::Surface();
+		copy->copyFrom(*entry.bitmap);
+		return copy;
+	}
+
+	Graphics::Surface *bitmap = decode(room, node, face);
+	if (!bitmap)
+		return 0;
+
+	// The decoded face goes to the caller, the cache keeps a copy for the next visits
+	Graphics::Surface *copy = new Graphics::Surface();
+	copy->copyFrom(*bitmap);
+	insert(room, node, face, copy);
+	return bitmap;
+}
+
+void FaceCache::queueNode(uint16 node) {
+	for (uint16 face = 1; face <= 6; face++) {
+		Request request;
+		request.node = node;
+		request.face = face;
+		_prefetchQueue.push(request);
+	}
+}
+
+void FaceCache::prefetchReachableNodes(uint16 node) {
+	_prefetchQueue.clear();
+
+	NodePtr nodeData = _vm->_db->getNodeData(node, _vm->_state->getLocationRoom(), _vm->_state->getLocationAge());
+	if (!nodeData)
+		return;
+
+	// Keep room in the cache for the faces of the current node
+	const uint maxNodes = kMaxFaces / 6 - 1;
+
+	Common::Array<uint16> reachable;
+	for (uint i = 0; i < nodeData->hotspots.size(); i++) {
+		const Common::Array<Opcode> &script = nodeData->hotspots[i].script;
+
+		for (uint j = 0; j < script.size(); j++) {
+			const Opcode &cmd = script[j];
+
+			// Look for the destinations of the go to node opcodes
+			// in the same room, see Script::chooseNextNode and the following opcodes
+			int16 destinations[2];
+			uint destinationCount = 0;
+			switch (cmd.op) {
+			case 135: // chooseNextNode
+				destinations[destinationCount++] = cmd.args[1];
+				destinations[destinationCount++] = cmd.args[2];
+				break;
+			case 136: // goToNodeTransition
+			case 137: // goToNodeTrans2
+			case 138: // goToNodeTrans1
+			case 140: // zipToNode
+				destinations[destinationCount++] = cmd.args[0];
+				break;
+			default:
+				break;
+			}
+
+			for (uint k = 0; k < destinationCount; k++) {
+				uint16 destination = _vm->_state->valueOrVarValue(destinations[k]);
+				if (destination == 0 || destination == node || reachable.size() >= maxNodes)
+					continue;
+
+				bool queued = false;
+				for (uint l = 0; l < reachable.size(); l++)
+					queued |= reachable[l] == destination;
+
+				if (!queued) {
+					reachable.push_back(destination);
+					queueNode(destination);
+				}
+			}
+		}
+	}
+
+	debugC(kDebugNode, "Prefetching the faces of %d nodes reachable from node %d", reachable.size(), node);
+}
+
+void FaceCache::decodeNextPrefetchedFace() {
+	if (_prefetchQueue.empty())
+		return;
+
+	Common::String room = getCurrentRoomName();
+
+	while (!_prefetchQueue.empty()) {
+		Request request = _prefetchQueue.pop();
+
+		if (find(room, request.node, request.face) != _entries.end())
+			continue; // Already cached
+
+		// Frame nodes do not have cube faces, skip them
+		Graphics::Surface *bitmap = decode(room, request.node, request.face);
+		if (bitmap) {
+			insert(room, request.node, request.face, bitmap);
+			break;
+		}
+	}
+}
+
+} // End of namespace Myst3
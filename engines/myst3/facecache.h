@@ -0,0 +1,103 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef FACECACHE_H_
+#define FACECACHE_H_
+
+#include "common/list.h"
+#include "common/queue.h"
+#include "common/str.h"
+
+namespace Graphics {
+struct Surface;
+}
+
+namespace Myst3 {
+
+class Myst3Engine;
+
+/**
+ * Keeps the most recently decoded cube faces, so that going back
+ * to a node does not need decoding its faces again.
+ *
+ * The faces of the nodes reachable from the hotspots of the current node
+ * are also decoded ahead of time, one face per frame, so that moving to
+ * one of them usually does not decode anything.
+ */
+class FaceCache {
+public:
+	FaceCache(Myst3Engine *vm);
+	~FaceCache();
+
+	/**
+	 * Get a copy of a cube face of a node of the current room
+	 *
+	 * The caller owns the returned surface.
+	 *
+	 * @return the face, or 0 if it does not exist
+	 */
+	Graphics::Surface *getCubeFace(uint16 node, uint16 face);
+
+	/**
+	 * Replace the prefetch queue with the faces of the nodes
+	 * the hotspots of the specified node of the current room lead to
+	 */
+	void prefetchReachableNodes(uint16 node);
+
+	/** Decode the next face from the prefetch queue, if any */
+	void decodeNextPrefetchedFace();
+
+	/** Free all the cached faces and empty the prefetch queue */
+	void clear();
+
+private:
+	/** Maximum number of decoded faces kept, each takes 1.6 MB */
+	static const uint kMaxFaces = 24;
+
+	struct Entry {
+		Common::String room;
+		uint16 node;
+		uint16 face;
+		Graphics::Surface *bitmap;
+	};
+
+	struct Request {
+		uint16 node;
+		uint16 face;
+	};
+
+	Myst3Engine *_vm;
+
+	/** Cached faces, the most recently used first */
+	Common::List<Entry> _entries;
+	Common::Queue<Request> _prefetchQueue;
+
+	Common::String getCurrentRoomName() const;
+	Common::List<Entry>::iterator find(const Common::String &room, uint16 node, uint16 face);
+	Graphics::Surface *decode(const Common::String &room, uint16 node, uint16 face);
+	void insert(const Common::String &room, uint16 node, uint16 face, Graphics::Surface *bitmap);
+	void queueNode(uint16 node);
+};
+
+} // End of namespace Myst3
+
+#endif // FACECACHE_H_
@@ -73,6 +73,8 @@ void TinyGLRenderer::init() {
 	_fb = new TinyGL::FrameBuffer(kOriginalWidth, kOriginalHeight, screenBuffer);
 	TinyGL::glInit(_fb, 512);
 	tglEnableDirtyRects(ConfMan.getBool("dirtyrects"));
+	tglEnableTiledRendering(ConfMan.getBool("tiledrendering"));
+	tglEnableTextureFiltering(ConfMan.getBool("texturefiltering"));
 
 	tglMatrixMode(TGL_PROJECTION);
 	tglLoadIdentity();
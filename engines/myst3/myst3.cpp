@@ -38,6 +38,7 @@
 #include "engines/myst3/console.h"
 #include "engines/myst3/database.h"
 #include "engines/myst3/effects.h"
+#include "engines/myst3/facecache.h"
 #include "engines/myst3/myst3.h"
 #include "engines/myst3/nodecube.h"
 #include "engines/myst3/nodeframe.h"
@@ -64,7 +65,7 @@ namespace Myst3 {
 
 Myst3Engine::Myst3Engine(OSystem *syst, const Myst3GameDescription *version) :
 		Engine(syst), _system(syst), _gameDescription(version),
-		_db(0), _console(0), _scriptEngine(0),
+		_db(0), _faceCache(0), _console(0), _scriptEngine(0),
 		_state(0), _node(0), _scene(0), _archiveNode(0),
 		_cursor(0), _inventory(0), _gfx(0), _menu(0),
 		_rnd(0), _sound(0), _ambient(0),
@@ -117,6 +118,7 @@ Myst3Engine::~Myst3Engine() {
 	delete _inventory;
 	delete _cursor;
 	delete _scene;
+	delete _faceCache;
 	delete _archiveNode;
 	delete _db;
 	delete _scriptEngine;
@@ -167,6 +169,7 @@ Common::Error Myst3Engine::run() {
 		_menu = new PagingMenu(this);
 	}
 	_archiveNode = new Archive();
+	_faceCache = new FaceCache(this);
 
 	_system->showMouse(false);
 
@@ -208,6 +211,10 @@ Common::Error Myst3Engine::run() {
 		}
 
 		drawFrame();
+
+		// Spread the decoding of the faces of the nodes the player
+		// may go to next over the following frames
+		_faceCache->decodeNextPrefetchedFace();
 	}
 
 	unloadNode();
@@ -843,6 +850,8 @@ void Myst3Engine::loadNode(uint16 nodeID, uint32 roomID, uint32 ageID) {
 	_shakeEffect = ShakeEffect::create(this);
 	_rotationEffect = RotationEffect::create(this);
 
+	_faceCache->prefetchReachableNodes(_state->getLocationNode());
+
 	// WORKAROUND: In Narayan, the scripts in node NACH 9 test on var 39
 	// without first reinitializing it leading to Saavedro not always giving
 	// Releeshan to the player when he is trapped between both shields.
@@ -1356,38 +1365,17 @@ Graphics::Surface *Myst3Engine::loadTexture(uint16 id) {
 Graphics::Surface *Myst3Engine::decodeJpeg(const DirectorySubEntry *jpegDesc) {
 	Common::MemoryReadStream *jpegStream = jpegDesc->getData();
 
+	// Decode straight to RGBA into a surface the caller will own.
+	// RGBA being the order of the bytes in memory, not in a 32 bits word.
+	Graphics::Surface *rgbaSurface = new Graphics::Surface();
+
 	Image::JPEGDecoder jpeg;
+	jpeg.setOutputPixelFormat(Texture::getRGBAPixelFormat());
+	jpeg.setOutputSurface(rgbaSurface);
 	if (!jpeg.loadStream(*jpegStream))
 		error("Could not decode Myst III JPEG");
 	delete jpegStream;
 
-	const Graphics::Surface *bitmap = jpeg.getSurface();
-	assert(bitmap->format == Graphics::PixelFormat(4, 8, 8, 8, 0, 24, 16, 8, 0));
-
-	// Convert the surface to RGBA if needed.
-	// RGBA being the order of the bytes in memory, not in a 32 bits word.
-	Graphics::PixelFormat rgbaFormat = Texture::getRGBAPixelFormat();
-	Graphics::Surface *rgbaSurface = new Graphics::Surface();
-
-#ifdef SCUMM_BIG_ENDIAN
-	assert(rgbaFormat == Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
-	rgbaSurface->copyFrom(*bitmap);
-	rgbaSurface->format = rgbaFormat;
-#else
-	assert(rgbaFormat == Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
-
-	rgbaSurface->create(bitmap->w, bitmap->h, rgbaFormat);
-
-	// Use SWAP_BYTES_32 as an optimization. This path is hot.
-	for (uint y = 0; y < bitmap->h; y++) {
-		const uint32 *srcRow = (const uint32 *) bitmap->getBasePtr(0, y);
-		uint32 *dstRow = (uint32 *) rgbaSurface->getBasePtr(0, y);
-		for (uint x = 0; x < bitmap->w; x++) {
-			*dstRow++ = SWAP_BYTES_32(*srcRow++);
-		}
-	}
-#endif
-
 	return rgbaSurface;
 }
 
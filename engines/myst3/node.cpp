@@ -32,7 +32,11 @@
 namespace Myst3 {
 
 void Face::setTextureFromJPEG(const DirectorySubEntry *jpegDesc) {
-	_bitmap = Myst3Engine::decodeJpeg(jpegDesc);
+	setTextureFromBitmap(Myst3Engine::decodeJpeg(jpegDesc));
+}
+
+void Face::setTextureFromBitmap(Graphics::Surface *bitmap) {
+	_bitmap = bitmap;
 	_texture = _vm->_gfx->createTexture(_bitmap);
 
 	// Set the whole texture as dirty
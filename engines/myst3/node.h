@@ -48,6 +48,7 @@ public:
 	~Face();
 
 	void setTextureFromJPEG(const DirectorySubEntry *jpegDesc);
+	void setTextureFromBitmap(Graphics::Surface *bitmap);
 
 	void addTextureDirtyRect(const Common::Rect &rect);
 	bool isTextureDirty() { return _textureDirty; }
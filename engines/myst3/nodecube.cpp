@@ -21,7 +21,7 @@
  */
 
 #include "engines/myst3/nodecube.h"
-#include "engines/myst3/directorysubentry.h"
+#include "engines/myst3/facecache.h"
 #include "engines/myst3/myst3.h"
 
 #include "common/debug.h"
@@ -33,13 +33,13 @@ NodeCube::NodeCube(Myst3Engine *vm, uint16 id) :
 	_is3D = true;
 
 	for (int i = 0; i < 6; i++) {
-		const DirectorySubEntry *jpegDesc = _vm->getFileDescription("", id, i + 1, DirectorySubEntry::kCubeFace);
+		Graphics::Surface *bitmap = _vm->_faceCache->getCubeFace(id, i + 1);
 
-		if (!jpegDesc)
+		if (!bitmap)
 			error("Face %d does not exist", id);
 
 		_faces[i] = new Face(_vm);
-		_faces[i]->setTextureFromJPEG(jpegDesc);
+		_faces[i]->setTextureFromBitmap(bitmap);
 	}
 }
 
@@ -95,12 +95,25 @@ Common::String XARCMember::readString(Common::ReadStream &stream) {
 
 // ARCHIVE
 
+XARCArchive::XARCArchive() :
+	_file(nullptr) {
+}
+
+XARCArchive::~XARCArchive() {
+	if (_file) {
+		_file->decRef();
+	}
+}
+
 bool XARCArchive::open(const Common::String &filename) {
-	Common::File stream;
-	if (!stream.open(filename)) {
+	Common::File *file = new Common::File();
+	if (!file->open(filename)) {
+		delete file;
 		return false;
 	}
 
+	Common::File &stream = *file;
+
 	_filename = filename;
 
 	// Unknown: always 1? version?
@@ -120,12 +133,23 @@ bool XARCArchive::open(const Common::String &filename) {
 
 	for (uint32 i = 0; i < numFiles; i++) {
 		XARCMember *member = new XARCMember(this, stream, offset);
-		_members.push_back(Common::ArchiveMemberPtr(member));
+		Common::ArchiveMemberPtr memberPtr(member);
+		_members.push_back(memberPtr);
+
+		// Only index the first member with a given name, which is the one that used to be found
+		if (!_memberIndex.contains(member->getName())) {
+			_memberIndex[member->getName()] = memberPtr;
+		}
 
 		// Set the offset to the next member
 		offset += member->getLength();
 	}
 
+	if (_file) {
+		_file->decRef();
+	}
+	_file = new Common::LockedSeekableReadStream(file);
+
 	return true;
 }
 
@@ -134,15 +158,7 @@ Common::String XARCArchive::getFilename() const {
 }
 
 bool XARCArchive::hasFile(const Common::String &name) const {
-	for (Common::ArchiveMemberList::const_iterator it = _members.begin(); it != _members.end(); ++it) {
-		if ((*it)->getName() == name) {
-			// Found it
-			return true;
-		}
-	}
-
-	// Not found
-	return false;
+	return _memberIndex.contains(name);
 }
 
 int XARCArchive::listMatchingMembers(Common::ArchiveMemberList &list, const Common::String &pattern) const {
@@ -170,48 +186,28 @@ int XARCArchive::listMembers(Common::ArchiveMemberList &list) const {
 }
 
 const Common::ArchiveMemberPtr XARCArchive::getMember(const Common::String &name) const {
-	for (Common::ArchiveMemberList::const_iterator it = _members.begin(); it != _members.end(); ++it) {
-		if ((*it)->getName() == name) {
-			// Found it
-			return *it;
-		}
+	MemberMap::const_iterator it = _memberIndex.find(name);
+	if (it == _memberIndex.end()) {
+		// Not found, return an empty ptr
+		return Common::ArchiveMemberPtr();
 	}
 
-	// Not found, return an empty ptr
-	return Common::ArchiveMemberPtr();
+	return it->_value;
 }
 
 Common::SeekableReadStream *XARCArchive::createReadStreamForMember(const Common::String &name) const {
-	for (Common::ArchiveMemberList::const_iterator it = _members.begin(); it != _members.end(); ++it) {
-		if ((*it)->getName() == name) {
-			// Found it
-			return createReadStreamForMember((const XARCMember *)it->get());
-		}
+	MemberMap::const_iterator it = _memberIndex.find(name);
+	if (it == _memberIndex.end()) {
+		// Not found
+		return 0;
 	}
 
-	// Not found
-	return 0;
+	return createReadStreamForMember((const XARCMember *)it->_value.get());
 }
 
 Common::SeekableReadStream *XARCArchive::createReadStreamForMember(const XARCMember *member) const {
-	// Open the xarc file
-	Common::File *f = new Common::File;
-	if (!f)
-		return NULL;
-
-	if (!f->open(_filename)) {
-		delete f;
-		return NULL;
-	}
-
-	// Return the substream that contains the archive member
-	uint32 offset = member->getOffset();
-	uint32 length = member->getLength();
-	return new Common::SeekableSubReadStream(f, offset, offset + length, DisposeAfterUse::YES);
-
-	// Different approach: keep the archive open and read full resources to memory
-	//f.seek(member->getOffset());
-	//return f.readStream(member->getLength());
+	// Return a stream reading the archive member from the shared archive file
+	return new Common::LockedSeekableSubReadStream(_file, member->getOffset(), member->getOffset() + member->getLength());
 }
 
 } // End of namespace Formats
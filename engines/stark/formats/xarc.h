@@ -24,8 +24,14 @@
 #define STARK_ARCHIVE_H
 
 #include "common/archive.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/stream.h"
 
+namespace Common {
+class LockedSeekableReadStream;
+}
+
 namespace Stark {
 namespace Formats {
 
@@ -33,6 +39,9 @@ class XARCMember;
 
 class XARCArchive : public Common::Archive {
 public:
+	XARCArchive();
+	~XARCArchive();
+
 	bool open(const Common::String &filename);
 	Common::String getFilename() const;
 
@@ -46,8 +55,14 @@ public:
 	Common::SeekableReadStream *createReadStreamForMember(const XARCMember *member) const;
 
 private:
+	typedef Common::HashMap<Common::String, Common::ArchiveMemberPtr> MemberMap;
+
 	Common::String _filename;
 	Common::ArchiveMemberList _members;
+	MemberMap _memberIndex;
+
+	// The open archive file, the streams of its members hold their own reference to it
+	Common::LockedSeekableReadStream *_file;
 };
 
 } // End of namespace Formats
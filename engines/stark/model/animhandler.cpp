@@ -61,6 +61,10 @@ void AnimHandler::setAnim(SkeletonAnim *anim) {
 
 	_anim = anim;
 	_animTime = 0;
+
+	for (uint i = 0; i < _animKeyCursors.size(); i++) {
+		_animKeyCursors[i] = 0;
+	}
 }
 
 void AnimHandler::setModel(Model *model) {
@@ -71,13 +75,13 @@ void AnimHandler::setNode(uint32 time, BoneNode *bone, const BoneNode *parent) {
 	const Common::Array<BoneNode *> &bones = _model->getBones();
 
 	if (_blendTimeRemaining <= 0) {
-		_anim->getCoordForBone(time, bone->_idx, bone->_animPos, bone->_animRot);
+		_anim->getCoordForBone(time, bone->_idx, bone->_animPos, bone->_animRot, _animKeyCursors[bone->_idx]);
 	} else {
 		// Blend the coordinates of the previous and the current animation
 		Math::Vector3d previousAnimPos, animPos;
 		Math::Quaternion previousAnimRot, animRot;
-		_blendAnim->getCoordForBone(_blendAnimTime, bone->_idx, previousAnimPos, previousAnimRot);
-		_anim->getCoordForBone(time, bone->_idx, animPos, animRot);
+		_blendAnim->getCoordForBone(_blendAnimTime, bone->_idx, previousAnimPos, previousAnimRot, _blendAnimKeyCursors[bone->_idx]);
+		_anim->getCoordForBone(time, bone->_idx, animPos, animRot, _animKeyCursors[bone->_idx]);
 
 		float blendingRatio = 1.0 - _blendTimeRemaining / (float)_blendDuration;
 
@@ -115,6 +119,11 @@ void AnimHandler::animate(uint32 time) {
 	//  - Process that childs children
 
 	const Common::Array<BoneNode *> &bones = _model->getBones();
+	if (_animKeyCursors.size() != bones.size()) {
+		_animKeyCursors.resize(bones.size());
+		_blendAnimKeyCursors.resize(bones.size());
+	}
+
 	if (deltaTime >= 0) {
 		setNode(time, bones[0], nullptr);
 		_animTime = time;
@@ -125,6 +134,7 @@ void AnimHandler::startBlending() {
 	_blendTimeRemaining = _blendDuration;
 	_blendAnim = _previousAnim;
 	_blendAnimTime = _previousAnimTime;
+	_blendAnimKeyCursors = _animKeyCursors;
 }
 
 void AnimHandler::updateBlending(int32 deltaTime) {
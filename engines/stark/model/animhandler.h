@@ -23,6 +23,7 @@
 #ifndef STARK_MODEL_ANIM_HANDLER_H
 #define STARK_MODEL_ANIM_HANDLER_H
 
+#include "common/array.h"
 #include "common/scummsys.h"
 
 namespace Stark {
@@ -64,12 +65,14 @@ private:
 
 	SkeletonAnim *_anim;
 	int32 _animTime;
+	Common::Array<uint32> _animKeyCursors;
 
 	SkeletonAnim *_previousAnim;
 	int32 _previousAnimTime;
 
 	SkeletonAnim *_blendAnim;
 	int32 _blendAnimTime;
+	Common::Array<uint32> _blendAnimKeyCursors;
 	int32 _blendTimeRemaining;
 
 	Model *_model;
@@ -68,6 +68,11 @@ void SkeletonAnim::createFromStream(ArchiveReadStream *stream) {
 }
 
 void SkeletonAnim::getCoordForBone(uint32 time, int boneIdx, Math::Vector3d &pos, Math::Quaternion &rot) const {
+	uint32 keyCursor = 0;
+	getCoordForBone(time, boneIdx, pos, rot, keyCursor);
+}
+
+void SkeletonAnim::getCoordForBone(uint32 time, int boneIdx, Math::Vector3d &pos, Math::Quaternion &rot, uint32 &keyCursor) const {
 	const Common::Array<AnimKey> &keys = _boneAnims[boneIdx]._keys;
 
 	if (keys.size() == 1) {
@@ -78,29 +83,55 @@ void SkeletonAnim::getCoordForBone(uint32 time, int boneIdx, Math::Vector3d &pos
 		return;
 	}
 
-	for (Common::Array<AnimKey>::const_iterator it = keys.begin(); it < keys.end(); ++it) {
-		if (it->_time == time) {
-			const AnimKey *key = it;
-			pos = key->_pos;
-			rot = key->_rot;
+	uint32 keyIdx = findKey(keys, time, keyCursor);
+	if (keyIdx >= keys.size()) {
+		warning("Unable to animate bone '%d' at %d ms", boneIdx, time);
+		return;
+	}
+
+	keyCursor = keyIdx;
 
-			return;
-		} else if (it->_time > time) {
-			// Between two key frames, interpolate
-			const AnimKey *a = it;
-			--it;
-			const AnimKey *b = it;
+	if (keys[keyIdx]._time == time || keyIdx == 0) {
+		const AnimKey *key = &keys[keyIdx];
+		pos = key->_pos;
+		rot = key->_rot;
+	} else {
+		// Between two key frames, interpolate
+		const AnimKey *a = &keys[keyIdx];
+		const AnimKey *b = &keys[keyIdx - 1];
 
-			float t = (float)(time - b->_time) / (float)(a->_time - b->_time);
+		float t = (float)(time - b->_time) / (float)(a->_time - b->_time);
 
-			pos = b->_pos + (a->_pos - b->_pos) * t;
-			rot = b->_rot.slerpQuat(a->_rot, t);
+		pos = b->_pos + (a->_pos - b->_pos) * t;
+		rot = b->_rot.slerpQuat(a->_rot, t);
+	}
+}
+
+uint32 SkeletonAnim::findKey(const Common::Array<AnimKey> &keys, uint32 time, uint32 keyCursor) {
+	// Animations are usually played forward, so the key is often the cursor
+	// or one of the few following keys
+	for (uint32 i = keyCursor; i < keys.size() && i < keyCursor + 3; i++) {
+		if (keys[i]._time >= time) {
+			if (i == 0 || keys[i - 1]._time < time) {
+				return i;
+			}
+			break;
+		}
+	}
 
-			return;
+	// Otherwise, binary search for the first key at or after the timestamp
+	uint32 first = 0;
+	uint32 last = keys.size();
+	while (first < last) {
+		uint32 middle = first + (last - first) / 2;
+		if (keys[middle]._time < time) {
+			first = middle + 1;
+		} else {
+			last = middle;
 		}
 	}
 
-	warning("Unable to animate bone '%d' at %d ms", boneIdx, time);
+	return first;
 }
 
 } // End of namespace Stark
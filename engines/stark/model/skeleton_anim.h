@@ -45,6 +45,14 @@ public:
 	 */
 	void getCoordForBone(uint32 time, int boneIdx, Math::Vector3d &pos, Math::Quaternion &rot) const;
 
+	/**
+	 * Get the interpolated bone coordinate for a given bone at a given animation timestamp
+	 *
+	 * The key cursor is the index of the key found by the previous call for the bone.
+	 * It is used as the starting point of the search, and updated with the found key.
+	 */
+	void getCoordForBone(uint32 time, int boneIdx, Math::Vector3d &pos, Math::Quaternion &rot, uint32 &keyCursor) const;
+
 	/**
 	 * Get total animation length (in ms)
 	 */
@@ -61,6 +69,9 @@ private:
 		Common::Array<AnimKey> _keys;
 	};
 
+	/** Find the index of the first key at or after a timestamp, or the key count if there is none */
+	static uint32 findKey(const Common::Array<AnimKey> &keys, uint32 time, uint32 keyCursor);
+
 	uint32 _id, _ver, _u1, _u2, _time;
 
 	Common::Array<BoneAnim> _boneAnims;
@@ -22,53 +22,75 @@
 
 #include "engines/stark/movement/shortestpath.h"
 
-#include "engines/stark/hash-ptr.h"
 #include "engines/stark/resources/floor.h"
 
 namespace Stark {
 
-ShortestPath::NodeList ShortestPath::search(const Resources::FloorEdge *start, const Resources::FloorEdge *goal) {
-	NodeList frontier;
-	NodePrecedenceMap cameFrom;
-	NodeCostMap costSoFar;
+ShortestPath::NodeList ShortestPath::search(const Resources::Floor *floor, const Resources::FloorEdge *start, const Resources::FloorEdge *goal) {
+	Node unreached;
+	unreached.cameFrom = nullptr;
+	unreached.costSoFar = 0;
+	unreached.estimatedCost = 0;
+	unreached.heapIndex = -1;
+	unreached.reached = false;
+
+	_nodes.resize(floor->getEdgeCount());
+	for (uint i = 0; i < _nodes.size(); i++) {
+		_nodes[i] = unreached;
+	}
+	_frontier.clear();
+
+	Math::Vector3d goalPosition = goal->getPosition();
 
-	frontier.push_back(start);
-	cameFrom[start] = nullptr;
-	costSoFar[start] = 0;
+	Node &startNode = _nodes[start->getIndex()];
+	startNode.reached = true;
+	startNode.estimatedCost = start->getPosition().getDistanceTo(goalPosition);
+	pushFrontier(start);
 
-	while (!frontier.empty()) {
-		const Resources::FloorEdge *current = popEdgeWithLowestCost(frontier, costSoFar);
+	while (!_frontier.empty()) {
+		const Resources::FloorEdge *current = popFrontier();
 
 		if (current == goal)
 			break;
 
-		Common::Array<Resources::FloorEdge *> neighbours = current->getNeighbours();
+		float currentCost = _nodes[current->getIndex()].costSoFar;
+
+		const Common::Array<Resources::FloorEdge *> &neighbours = current->getNeighbours();
 		for (uint i = 0; i < neighbours.size(); i++) {
 			const Resources::FloorEdge *next = neighbours[i];
 			if (!next->isEnabled())
 				continue;
 
-			float newCost = costSoFar[current] + current->costTo(next);
-			if (!costSoFar.contains(next) || newCost < costSoFar[next]) {
-				frontier.push_back(next);
-				cameFrom[next] = current;
-				costSoFar[next] = newCost;
+			float newCost = currentCost + current->costTo(next);
+
+			Node &nextNode = _nodes[next->getIndex()];
+			if (!nextNode.reached || newCost < nextNode.costSoFar) {
+				nextNode.cameFrom = current;
+				nextNode.costSoFar = newCost;
+				nextNode.estimatedCost = newCost + next->getPosition().getDistanceTo(goalPosition);
+
+				if (nextNode.heapIndex >= 0) {
+					siftUp(nextNode.heapIndex);
+				} else {
+					pushFrontier(next);
+				}
+
+				nextNode.reached = true;
 			}
 		}
 	}
 
-	return rebuildPath(start, goal, cameFrom);
+	return rebuildPath(start, goal);
 }
 
-ShortestPath::NodeList ShortestPath::rebuildPath(const Resources::FloorEdge *start, const Resources::FloorEdge *goal,
-                                                 const NodePrecedenceMap &cameFrom) const {
+ShortestPath::NodeList ShortestPath::rebuildPath(const Resources::FloorEdge *start, const Resources::FloorEdge *goal) const {
 	NodeList path;
 
 	const Resources::FloorEdge *current = goal;
 	path.push_front(goal);
 
 	while (current && current != start) {
-		current = cameFrom[current];
+		current = _nodes[current->getIndex()].cameFrom;
 		path.push_front(current);
 	}
 
@@ -81,20 +103,65 @@ ShortestPath::NodeList ShortestPath::rebuildPath(const Resources::FloorEdge *sta
 	return path;
 }
 
-const Resources::FloorEdge *ShortestPath::popEdgeWithLowestCost(NodeList &frontier, const NodeCostMap &costSoFar) const {
-	// Poor man's priority queue using a list ...
-	NodeList::iterator lowestCostItem = frontier.begin();
-	for (NodeList::iterator it = frontier.begin(); it != frontier.end(); it++) {
-		if (costSoFar[*it] < costSoFar[*lowestCostItem]) {
-			lowestCostItem = it;
-		}
-	}
+void ShortestPath::pushFrontier(const Resources::FloorEdge *edge) {
+	_frontier.push_back(edge);
+	_nodes[edge->getIndex()].heapIndex = _frontier.size() - 1;
+	siftUp(_frontier.size() - 1);
+}
 
-	const Resources::FloorEdge *result = *lowestCostItem;
+const Resources::FloorEdge *ShortestPath::popFrontier() {
+	const Resources::FloorEdge *result = _frontier[0];
 
-	frontier.erase(lowestCostItem);
+	swapFrontier(0, _frontier.size() - 1);
+	_frontier.pop_back();
+	_nodes[result->getIndex()].heapIndex = -1;
+
+	if (!_frontier.empty()) {
+		siftDown(0);
+	}
 
 	return result;
 }
 
+void ShortestPath::siftUp(uint32 heapIndex) {
+	while (heapIndex > 0) {
+		uint32 parent = (heapIndex - 1) / 2;
+		if (_nodes[_frontier[parent]->getIndex()].estimatedCost <= _nodes[_frontier[heapIndex]->getIndex()].estimatedCost)
+			break;
+
+		swapFrontier(parent, heapIndex);
+		heapIndex = parent;
+	}
+}
+
+void ShortestPath::siftDown(uint32 heapIndex) {
+	while (true) {
+		uint32 lowest = heapIndex;
+		uint32 left = 2 * heapIndex + 1;
+		uint32 right = left + 1;
+
+		if (left < _frontier.size()
+		    && _nodes[_frontier[left]->getIndex()].estimatedCost < _nodes[_frontier[lowest]->getIndex()].estimatedCost) {
+			lowest = left;
+		}
+
+		if (right < _frontier.size()
+		    && _nodes[_frontier[right]->getIndex()].estimatedCost < _nodes[_frontier[lowest]->getIndex()].estimatedCost) {
+			lowest = right;
+		}
+
+		if (lowest == heapIndex)
+			break;
+
+		swapFrontier(lowest, heapIndex);
+		heapIndex = lowest;
+	}
+}
+
+void ShortestPath::swapFrontier(uint32 heapIndex1, uint32 heapIndex2) {
+	SWAP(_frontier[heapIndex1], _frontier[heapIndex2]);
+	_nodes[_frontier[heapIndex1]->getIndex()].heapIndex = heapIndex1;
+	_nodes[_frontier[heapIndex2]->getIndex()].heapIndex = heapIndex2;
+}
+
 } // End of namespace Stark
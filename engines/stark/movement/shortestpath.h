@@ -23,35 +23,50 @@
 #ifndef STARK_MOVEMENT_SHORTEST_PATH_H
 #define STARK_MOVEMENT_SHORTEST_PATH_H
 
+#include "common/array.h"
 #include "common/list.h"
-#include "common/hashmap.h"
 
 namespace Stark {
 
 namespace Resources {
+class Floor;
 class FloorEdge;
 }
 
 /**
  * Find the shortest path between two nodes in a graph
  *
- * This is an implementation of Dijsktra's search algorithm
+ * This is an implementation of the A* search algorithm, using the straight
+ * line distance to the goal as the heuristic.
  */
 class ShortestPath {
 public:
 	typedef Common::List<const Resources::FloorEdge *> NodeList;
 
 	/** Computes the shortest path between the start and the goal graph nodes */
-	NodeList search(const Resources::FloorEdge *start, const Resources::FloorEdge *goal);
+	NodeList search(const Resources::Floor *floor, const Resources::FloorEdge *start, const Resources::FloorEdge *goal);
 
 private:
-	typedef Common::HashMap<const Resources::FloorEdge *, const Resources::FloorEdge *> NodePrecedenceMap;
-	typedef Common::HashMap<const Resources::FloorEdge *, float> NodeCostMap;
+	/** Search state for a floor edge, indexed by the edge index */
+	struct Node {
+		const Resources::FloorEdge *cameFrom;
+		float costSoFar;
+		float estimatedCost;
+		int32 heapIndex;
+		bool reached;
+	};
 
-	const Resources::FloorEdge *popEdgeWithLowestCost(NodeList &frontier, const NodeCostMap &costSoFar) const;
+	// Binary min-heap of the frontier edges, ordered by estimated cost
+	void pushFrontier(const Resources::FloorEdge *edge);
+	const Resources::FloorEdge *popFrontier();
+	void siftUp(uint32 heapIndex);
+	void siftDown(uint32 heapIndex);
+	void swapFrontier(uint32 heapIndex1, uint32 heapIndex2);
 
-	NodeList rebuildPath(const Resources::FloorEdge *start, const Resources::FloorEdge *goal,
-	                                    const NodePrecedenceMap &cameFrom) const;
+	NodeList rebuildPath(const Resources::FloorEdge *start, const Resources::FloorEdge *goal) const;
+
+	Common::Array<Node> _nodes;
+	Common::Array<const Resources::FloorEdge *> _frontier;
 };
 
 } // End of namespace Stark
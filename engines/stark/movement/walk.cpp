@@ -98,7 +98,7 @@ void Walk::updatePath() const {
 	}
 
 	ShortestPath pathSearch;
-	ShortestPath::NodeList edgePath = pathSearch.search(startFloorEdge, destinationFloorEdge);
+	ShortestPath::NodeList edgePath = pathSearch.search(floor, startFloorEdge, destinationFloorEdge);
 
 	for (ShortestPath::NodeList::const_iterator it = edgePath.begin(); it != edgePath.end(); it++) {
 		_path->addStep((*it)->getPosition());
@@ -36,7 +36,10 @@ namespace Resources {
 
 Floor::Floor(Object *parent, byte subType, uint16 index, const Common::String &name) :
 		Object(parent, subType, index, name),
-		_facesCount(0) {
+		_facesCount(0),
+		_gridColumns(0),
+		_gridRows(0),
+		_gridCellSize(1.0f) {
 	_type = TYPE;
 }
 
@@ -48,9 +51,18 @@ Math::Vector3d Floor::getVertex(uint32 index) const {
 }
 
 int32 Floor::findFaceContainingPoint(const Math::Vector3d &point) const {
-	for (uint32 i = 0; i < _faces.size(); i++) {
-		if (_faces[i]->hasVertices() && _faces[i]->isPointInside(point)) {
-			return i;
+	int32 cell = getGridCell(point);
+	if (cell < 0) {
+		// The point is outside of all the faces
+		return -1;
+	}
+
+	// The cell's faces are sorted by index, so the first face containing
+	// the point is the same as when testing all the faces in order
+	const Common::Array<uint32> &faces = _grid[cell].faces;
+	for (uint32 i = 0; i < faces.size(); i++) {
+		if (_faces[faces[i]]->isPointInside(point)) {
+			return faces[i];
 		}
 	}
 
@@ -62,14 +74,35 @@ void Floor::computePointHeightInFace(Math::Vector3d &point, uint32 faceIndex) co
 }
 
 int32 Floor::findFaceHitByRay(const Math::Ray &ray, Math::Vector3d &intersection) const {
-	for (uint32 i = 0; i < _faces.size(); i++) {
-		// TODO: Check the ray's intersection with an AABB first if this ends up being slow
-		if (_faces[i]->intersectRay(ray, intersection)) {
-			return i;
+	float tMin = 0.0f;
+	float tMax = FLT_MAX;
+	if (!clipToGrid(ray.getOrigin(), ray.getDirection(), true, tMin, tMax)) {
+		// The ray does not go through the floor's bounding box
+		return -1;
+	}
+
+	Common::Array<uint32> cells;
+	listGridCellsOnSegment(ray.getOrigin() + tMin * ray.getDirection(), ray.getOrigin() + tMax * ray.getDirection(), cells);
+
+	// Keep the hit face with the lowest index, like when testing all the faces in order
+	int32 hitFace = -1;
+	for (uint32 i = 0; i < cells.size(); i++) {
+		const Common::Array<uint32> &faces = _grid[cells[i]].faces;
+		for (uint32 j = 0; j < faces.size(); j++) {
+			if (hitFace >= 0 && faces[j] >= (uint32)hitFace) {
+				break;
+			}
+
+			Math::Vector3d faceIntersection;
+			if (_faces[faces[j]]->intersectRay(ray, faceIntersection)) {
+				hitFace = faces[j];
+				intersection = faceIntersection;
+				break;
+			}
 		}
 	}
 
-	return -1;
+	return hitFace;
 }
 
 int32 Floor::findFaceClosestToRay(const Math::Ray &ray, Math::Vector3d &center) const {
@@ -101,6 +134,10 @@ FloorFace *Floor::getFace(uint32 index) const {
 	return _faces[index];
 }
 
+uint32 Floor::getEdgeCount() const {
+	return _edges.size();
+}
+
 bool Floor::isSegmentInside(const Math::Line3d &segment) const {
 	// The segment is inside the floor if at least one of its extremities is,
 	// and it does not cross any floor border
@@ -111,10 +148,23 @@ bool Floor::isSegmentInside(const Math::Line3d &segment) const {
 		return false;
 	}
 
-	for (uint i = 0; i < _edges.size(); i++) {
-		const FloorEdge &edge = _edges[i];
-		if (edge.isFloorBorder() && edge.intersectsSegment(this, segment)) {
-			return false;
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+	Math::Vector3d direction = segment.end() - segment.begin();
+	if (!clipToGrid(segment.begin(), direction, false, tMin, tMax)) {
+		// The segment does not cross the floor's bounding box, so no border edge
+		return true;
+	}
+
+	Common::Array<uint32> cells;
+	listGridCellsOnSegment(segment.begin() + tMin * direction, segment.begin() + tMax * direction, cells);
+
+	for (uint i = 0; i < cells.size(); i++) {
+		const Common::Array<uint32> &borderEdges = _grid[cells[i]].borderEdges;
+		for (uint j = 0; j < borderEdges.size(); j++) {
+			if (_edges[borderEdges[j]].intersectsSegment(this, segment)) {
+				return false;
+			}
 		}
 	}
 
@@ -137,6 +187,7 @@ void Floor::onAllLoaded() {
 	_faces = listChildren<FloorFace>();
 
 	buildEdgeList();
+	buildGrid();
 }
 
 void Floor::saveLoad(ResourceSerializer *serializer) {
@@ -192,7 +243,190 @@ void Floor::addFaceEdgeToList(uint32 faceIndex, uint32 index1, uint32 index2) {
 		}
 	}
 
-	_edges.push_back(FloorEdge(startIndex, endIndex, faceIndex));
+	_edges.push_back(FloorEdge(startIndex, endIndex, faceIndex, _edges.size()));
+}
+
+void Floor::buildGrid() {
+	_grid.clear();
+	_gridColumns = 0;
+	_gridRows = 0;
+
+	// Compute the bounds of the faces
+	uint32 faceCount = 0;
+	for (uint i = 0; i < _faces.size(); i++) {
+		if (!_faces[i]->hasVertices()) {
+			continue;
+		}
+
+		for (uint j = 0; j < 3; j++) {
+			Math::Vector3d vertex = _vertices[_faces[i]->getVertexIndex(j)];
+			if (faceCount == 0 && j == 0) {
+				_gridMin = vertex;
+				_gridMax = vertex;
+			} else {
+				for (uint k = 0; k < 3; k++) {
+					_gridMin.setValue(k, MIN(_gridMin.getValue(k), vertex.getValue(k)));
+					_gridMax.setValue(k, MAX(_gridMax.getValue(k), vertex.getValue(k)));
+				}
+			}
+		}
+
+		faceCount++;
+	}
+
+	if (faceCount == 0) {
+		return;
+	}
+
+	// Pad the bounds so that points computed on the borders with rounding errors are still inside
+	Math::Vector3d size = _gridMax - _gridMin;
+	float padding = 0.001f * MAX(MAX(size.x(), size.y()), MAX(size.z(), 1.0f));
+	_gridMin -= Math::Vector3d(padding, padding, padding);
+	_gridMax += Math::Vector3d(padding, padding, padding);
+	size = _gridMax - _gridMin;
+
+	// Aim for about one face per cell
+	_gridCellSize = sqrt(size.x() * size.y() / faceCount);
+	_gridColumns = CLIP<uint32>((uint32)ceil(size.x() / _gridCellSize), 1, 256);
+	_gridRows = CLIP<uint32>((uint32)ceil(size.y() / _gridCellSize), 1, 256);
+	_gridCellSize = MAX(size.x() / _gridColumns, size.y() / _gridRows);
+
+	_grid.resize(_gridColumns * _gridRows);
+
+	for (uint i = 0; i < _faces.size(); i++) {
+		if (!_faces[i]->hasVertices()) {
+			continue;
+		}
+
+		Math::Vector3d min = _vertices[_faces[i]->getVertexIndex(0)];
+		Math::Vector3d max = min;
+		for (uint j = 1; j < 3; j++) {
+			Math::Vector3d vertex = _vertices[_faces[i]->getVertexIndex(j)];
+			for (uint k = 0; k < 3; k++) {
+				min.setValue(k, MIN(min.getValue(k), vertex.getValue(k)));
+				max.setValue(k, MAX(max.getValue(k), vertex.getValue(k)));
+			}
+		}
+
+		addToGrid(min, max, i, false);
+	}
+
+	for (uint i = 0; i < _edges.size(); i++) {
+		if (!_edges[i].isFloorBorder()) {
+			continue;
+		}
+
+		Math::Vector3d vertex1 = _vertices[_edges[i].getVertexIndex1()];
+		Math::Vector3d vertex2 = _vertices[_edges[i].getVertexIndex2()];
+		Math::Vector3d min(MIN(vertex1.x(), vertex2.x()), MIN(vertex1.y(), vertex2.y()), 0.0f);
+		Math::Vector3d max(MAX(vertex1.x(), vertex2.x()), MAX(vertex1.y(), vertex2.y()), 0.0f);
+
+		addToGrid(min, max, i, true);
+	}
+}
+
+void Floor::addToGrid(const Math::Vector3d &min, const Math::Vector3d &max, uint32 index, bool isBorderEdge) {
+	// Overlap the neighbour cells slightly so that items touching a cell border are found from both sides
+	float margin = 0.01f * _gridCellSize;
+
+	int32 column1 = CLIP<int32>(floor((min.x() - margin - _gridMin.x()) / _gridCellSize), 0, _gridColumns - 1);
+	int32 column2 = CLIP<int32>(floor((max.x() + margin - _gridMin.x()) / _gridCellSize), 0, _gridColumns - 1);
+	int32 row1 = CLIP<int32>(floor((min.y() - margin - _gridMin.y()) / _gridCellSize), 0, _gridRows - 1);
+	int32 row2 = CLIP<int32>(floor((max.y() + margin - _gridMin.y()) / _gridCellSize), 0, _gridRows - 1);
+
+	for (int32 row = row1; row <= row2; row++) {
+		for (int32 column = column1; column <= column2; column++) {
+			GridCell &cell = _grid[row * _gridColumns + column];
+			if (isBorderEdge) {
+				cell.borderEdges.push_back(index);
+			} else {
+				cell.faces.push_back(index);
+			}
+		}
+	}
+}
+
+int32 Floor::getGridCell(const Math::Vector3d &point) const {
+	if (_grid.empty()
+	    || point.x() < _gridMin.x() || point.x() > _gridMax.x()
+	    || point.y() < _gridMin.y() || point.y() > _gridMax.y()) {
+		return -1;
+	}
+
+	uint32 column = MIN<uint32>((point.x() - _gridMin.x()) / _gridCellSize, _gridColumns - 1);
+	uint32 row = MIN<uint32>((point.y() - _gridMin.y()) / _gridCellSize, _gridRows - 1);
+
+	return row * _gridColumns + column;
+}
+
+bool Floor::clipToGrid(const Math::Vector3d &origin, const Math::Vector3d &direction, bool clipHeight, float &tMin, float &tMax) const {
+	if (_grid.empty()) {
+		return false;
+	}
+
+	for (uint i = 0; i < (clipHeight ? 3 : 2); i++) {
+		float o = origin.getValue(i);
+		float d = direction.getValue(i);
+		float min = _gridMin.getValue(i);
+		float max = _gridMax.getValue(i);
+
+		if (d == 0.0f) {
+			if (o < min || o > max) {
+				return false;
+			}
+			continue;
+		}
+
+		float t1 = (min - o) / d;
+		float t2 = (max - o) / d;
+		if (t1 > t2) {
+			SWAP(t1, t2);
+		}
+
+		tMin = MAX(tMin, t1);
+		tMax = MIN(tMax, t2);
+		if (tMin > tMax) {
+			return false;
+		}
+	}
+
+	return tMax != FLT_MAX;
+}
+
+void Floor::listGridCellsOnSegment(const Math::Vector3d &begin, const Math::Vector3d &end, Common::Array<uint32> &cells) const {
+	float x = (begin.x() - _gridMin.x()) / _gridCellSize;
+	float y = (begin.y() - _gridMin.y()) / _gridCellSize;
+	float dx = (end.x() - _gridMin.x()) / _gridCellSize - x;
+	float dy = (end.y() - _gridMin.y()) / _gridCellSize - y;
+
+	int32 column = CLIP<int32>(floor(x), 0, _gridColumns - 1);
+	int32 row = CLIP<int32>(floor(y), 0, _gridRows - 1);
+	int32 endColumn = CLIP<int32>(floor(x + dx), 0, _gridColumns - 1);
+	int32 endRow = CLIP<int32>(floor(y + dy), 0, _gridRows - 1);
+
+	// Walk the cells by comparing the segment's parameter at the next vertical and horizontal cell borders
+	int32 stepColumn = dx > 0.0f ? 1 : -1;
+	int32 stepRow = dy > 0.0f ? 1 : -1;
+	float tDeltaX = dx != 0.0f ? fabs(1.0f / dx) : FLT_MAX;
+	float tDeltaY = dy != 0.0f ? fabs(1.0f / dy) : FLT_MAX;
+	float tMaxX = dx > 0.0f ? (column + 1 - x) / dx : (dx < 0.0f ? (column - x) / dx : FLT_MAX);
+	float tMaxY = dy > 0.0f ? (row + 1 - y) / dy : (dy < 0.0f ? (row - y) / dy : FLT_MAX);
+
+	while (true) {
+		cells.push_back(row * _gridColumns + column);
+
+		if (column == endColumn && row == endRow) {
+			break;
+		}
+
+		if (row == endRow || (column != endColumn && tMaxX < tMaxY)) {
+			tMaxX += tDeltaX;
+			column += stepColumn;
+		} else {
+			tMaxY += tDeltaY;
+			row += stepRow;
+		}
+	}
 }
 
 void Floor::enableFloorField(FloorField *floorfield, bool enable) {
@@ -212,11 +446,12 @@ void Floor::printData() {
 	}
 }
 
-FloorEdge::FloorEdge(uint16 vertexIndex1, uint16 vertexIndex2, uint32 faceIndex1) :
+FloorEdge::FloorEdge(uint16 vertexIndex1, uint16 vertexIndex2, uint32 faceIndex1, uint32 index) :
         _vertexIndex1(vertexIndex1),
         _vertexIndex2(vertexIndex2),
         _faceIndex1(faceIndex1),
         _faceIndex2(-1),
+        _index(index),
         _enabled(true) {
 }
 
@@ -228,7 +463,7 @@ void FloorEdge::setOtherFace(uint32 faceIndex) {
 	_faceIndex2 = faceIndex;
 }
 
-Common::Array<FloorEdge *> FloorEdge::getNeighbours() const {
+const Common::Array<FloorEdge *> &FloorEdge::getNeighbours() const {
 	return _neighbours;
 }
 
@@ -275,6 +510,18 @@ int32 FloorEdge::getFaceIndex2() const {
 	return _faceIndex2;
 }
 
+uint16 FloorEdge::getVertexIndex1() const {
+	return _vertexIndex1;
+}
+
+uint16 FloorEdge::getVertexIndex2() const {
+	return _vertexIndex2;
+}
+
+uint32 FloorEdge::getIndex() const {
+	return _index;
+}
+
 bool FloorEdge::isFloorBorder() const {
 	return _faceIndex2 == -1;
 }
@@ -51,7 +51,7 @@ class FloorField;
  */
 class FloorEdge {
 public:
-	FloorEdge(uint16 vertexIndex1, uint16 vertexIndex2, uint32 faceIndex1);
+	FloorEdge(uint16 vertexIndex1, uint16 vertexIndex2, uint32 faceIndex1, uint32 index);
 
 	/** Build a list of neighbour edges in the graph */
 	void buildNeighbours(const Floor *floor);
@@ -66,7 +66,7 @@ public:
 	bool hasVertices(uint16 vertexIndex1, uint16 vertexIndex2) const;
 
 	/** List the edge neighbour edges in the floor */
-	Common::Array<FloorEdge *> getNeighbours() const;
+	const Common::Array<FloorEdge *> &getNeighbours() const;
 
 	/**
 	 * Computes the cost for going to a neighbour edge
@@ -92,6 +92,13 @@ public:
 	int32 getFaceIndex1() const;
 	int32 getFaceIndex2() const;
 
+	/** Get the indices of the edge's vertices in the floor */
+	uint16 getVertexIndex1() const;
+	uint16 getVertexIndex2() const;
+
+	/** Get the edge's index in the floor's edge list */
+	uint32 getIndex() const;
+
 	/** Allow or disallow characters to path using this edge */
 	void enable(bool enable);
 
@@ -110,6 +117,7 @@ private:
 	Math::Vector3d _middle;
 	int32 _faceIndex1;
 	int32 _faceIndex2;
+	uint32 _index;
 
 	bool _enabled;
 
@@ -171,6 +179,9 @@ public:
 	/** Get a floor face by its index */
 	FloorFace *getFace(uint32 index) const;
 
+	/** Get the number of edges in the floor, edge indices are lower than this */
+	uint32 getEdgeCount() const;
+
 	/** Check if the segment is entirely inside the floor */
 	bool isSegmentInside(const Math::Line3d &segment) const;
 
@@ -184,10 +195,45 @@ protected:
 	void buildEdgeList();
 	void addFaceEdgeToList(uint32 faceIndex, uint32 index1, uint32 index2);
 
+	/**
+	 * Build a uniform grid over the floor's bounds when projected on a Z=0 plane
+	 *
+	 * Each grid cell lists the faces and border edges overlapping it, so that
+	 * the spatial queries only need to test the faces and edges near the query.
+	 */
+	void buildGrid();
+	void addToGrid(const Math::Vector3d &min, const Math::Vector3d &max, uint32 index, bool isBorderEdge);
+
+	/** Get the grid cell containing a point, or -1 if the point is outside of the grid */
+	int32 getGridCell(const Math::Vector3d &point) const;
+
+	/**
+	 * Restrict [tMin, tMax] to the part of the line origin + t * direction inside the grid bounds
+	 *
+	 * The height is only taken into account if clipHeight is set.
+	 * Return false if the line does not go through the grid.
+	 */
+	bool clipToGrid(const Math::Vector3d &origin, const Math::Vector3d &direction, bool clipHeight, float &tMin, float &tMax) const;
+
+	/** List the grid cells crossed by a segment, in the order they are crossed */
+	void listGridCellsOnSegment(const Math::Vector3d &begin, const Math::Vector3d &end, Common::Array<uint32> &cells) const;
+
+	struct GridCell {
+		Common::Array<uint32> faces;
+		Common::Array<uint32> borderEdges;
+	};
+
 	uint32 _facesCount;
 	Common::Array<Math::Vector3d> _vertices;
 	Common::Array<FloorFace *> _faces;
 	Common::Array<FloorEdge> _edges;
+
+	Common::Array<GridCell> _grid;
+	uint32 _gridColumns;
+	uint32 _gridRows;
+	float _gridCellSize;
+	Math::Vector3d _gridMin;
+	Math::Vector3d _gridMax;
 };
 
 } // End of namespace Resources
@@ -690,3 +690,13 @@ void tglEnableDirtyRects(bool enable) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	c->_enableDirtyRectangles = enable;
 }
+
+void tglEnableTiledRendering(bool enable) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	c->_enableTiledRendering = enable;
+}
+
+void tglEnableTextureFiltering(bool enable) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	c->_enableTextureFiltering = enable;
+}
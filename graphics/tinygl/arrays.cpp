@@ -27,6 +27,7 @@
  */
 
 #include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zdirtyrect.h"
 
 #define VERTEX_ARRAY    0x0001
 #define COLOR_ARRAY     0x0002
@@ -89,6 +90,51 @@ void glopDrawArrays(GLContext *c, GLParam *p) {
 	glopEnd(c, NULL);
 }
 
+void glopDrawElements(GLContext *c, GLParam *p) {
+	GLParam array_element[2];
+	GLParam begin[2];
+	int mode = p[1].i;
+	int count = p[2].i;
+	int type = p[3].i;
+	const void *indices = p[4].p;
+
+	begin[1].i = mode;
+	glopBegin(c, begin);
+
+	if (mode != TGL_TRIANGLES) {
+		for (int i = 0; i < count; i++) {
+			array_element[1].i = type == TGL_UNSIGNED_SHORT ? ((const uint16 *)indices)[i] : ((const uint32 *)indices)[i];
+			glopArrayElement(c, array_element);
+		}
+		glopEnd(c, NULL);
+		return;
+	}
+
+	// Triangles can share their vertices, so that every array element is only transformed and lit once.
+	c->vertex_indices.resize(count);
+	for (int i = 0; i < count; i++) {
+		int index = type == TGL_UNSIGNED_SHORT ? ((const uint16 *)indices)[i] : ((const uint32 *)indices)[i];
+		if (index >= (int)c->vertex_array_remap.size()) {
+			c->vertex_array_remap.resize(index + 1);
+		}
+		if (c->vertex_array_remap[index] == 0) {
+			c->vertex_array_remap[index] = c->vertex_n + 1;
+			array_element[1].i = index;
+			glopArrayElement(c, array_element);
+		}
+		c->vertex_indices[i] = c->vertex_array_remap[index] - 1;
+	}
+	for (int i = 0; i < count; i++) {
+		int index = type == TGL_UNSIGNED_SHORT ? ((const uint16 *)indices)[i] : ((const uint32 *)indices)[i];
+		c->vertex_array_remap[index] = 0;
+	}
+
+	if (count >= 3) {
+		tglIssueDrawCall(new Graphics::RasterizationDrawCall(c->vertex_indices.begin(), count - count % 3));
+	}
+	c->in_begin = 0;
+}
+
 void glopEnableClientState(GLContext *c, GLParam *p) {
 	c->client_states |= p[1].i;
 }
@@ -138,6 +184,17 @@ void tglDrawArrays(TGLenum mode, TGLint first, TGLsizei count) {
 	gl_add_op(p);
 }
 
+void tglDrawElements(TGLenum mode, TGLsizei count, TGLenum type, const TGLvoid *indices) {
+	TinyGL::GLParam p[5];
+	assert(type == TGL_UNSIGNED_SHORT || type == TGL_UNSIGNED_INT);
+	p[0].op = TinyGL::OP_DrawElements;
+	p[1].i = mode;
+	p[2].i = count;
+	p[3].i = type;
+	p[4].p = const_cast<void *>(indices);
+	gl_add_op(p);
+}
+
 void tglEnableClientState(TGLenum array) {
 	TinyGL::GLParam p[2];
 	p[0].op = TinyGL::OP_EnableClientState;
@@ -62,7 +62,7 @@ void glInit(void *zbuffer1, int textureSize) {
 	if ((textureSize & (textureSize - 1)))
 		error("glInit: texture size not power of two: %d", textureSize);
 
-	if (textureSize <= 1 || textureSize > 4096)
+	if (textureSize < 4 || textureSize > 4096)
 		error("glInit: texture size not allowed: %d", textureSize);
 
 	c = new GLContext();
@@ -71,7 +71,6 @@ void glInit(void *zbuffer1, int textureSize) {
 	c->fb = zbuffer;
 
 	c->fb->_textureSize = c->_textureSize = textureSize;
-	c->fb->_textureSizeMask = (textureSize - 1) << ZB_POINT_ST_FRAC_BITS;
 	c->renderRect = Common::Rect(0, 0, zbuffer->xsize, zbuffer->ysize);
 
 	// allocate GLVertex array
@@ -235,6 +234,14 @@ void glInit(void *zbuffer1, int textureSize) {
 	c->_drawCallAllocator[1].initialize(kDrawCallMemory);
 	c->_enableDirtyRectangles = true;
 
+	// Tiles span the whole width of the frame buffer, so that the per-pixel scissor
+	// test is only needed on the rows shared between two tiles.
+	c->_enableTiledRendering = false;
+	c->_tileWidth = zbuffer->xsize;
+	c->_tileHeight = 32;
+
+	c->_enableTextureFiltering = false;
+
 	Graphics::Internal::tglBlitResetScissorRect();
 }
 
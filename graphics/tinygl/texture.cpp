@@ -88,10 +88,87 @@ GLTexture *alloc_texture(GLContext *c, int h) {
 	t->handle = h;
 	t->disposed = false;
 	t->versionNumber = 0;
+	t->levelCount = 0;
+	t->minFilter = TGL_NEAREST;
+	t->magFilter = TGL_NEAREST;
 
 	return t;
 }
 
+// Stores an image with 32 bit texels in the tiled layout. The storage of the
+// previous image is kept when its size and format match, as with movie frames.
+static void storeTiledImage(GLImage *im, const Graphics::PixelFormat &pf, const byte *pixels, int width, int height) {
+	int tilesPerLine = (width + TEXTURE_TILE_SIZE - 1) >> TEXTURE_TILE_BITS;
+	int tileLines = (height + TEXTURE_TILE_SIZE - 1) >> TEXTURE_TILE_BITS;
+	int texelCount = (tilesPerLine * tileLines) << (2 * TEXTURE_TILE_BITS);
+
+	if (!im->pixmap || im->xsize != width || im->ysize != height || im->pixmap.getFormat() != pf) {
+		if (im->pixmap)
+			im->pixmap.free();
+		im->pixmap.create(pf, texelCount, DisposeAfterUse::NO);
+	}
+	im->xsize = width;
+	im->ysize = height;
+	im->tilesPerLine = tilesPerLine;
+	uint32 *dst = (uint32 *)im->pixmap.getRawBuffer();
+	memset(dst, 0, texelCount * sizeof(uint32));
+
+	const uint32 *src = (const uint32 *)pixels;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			dst[gl_tiledTexelOffset(x, y, im->tilesPerLine)] = *src++;
+		}
+	}
+}
+
+// Halves a tiled image with 32 bit texels by averaging blocks of 2x2 texels,
+// two channels at a time. The result is stored line by line.
+static void downsampleImage(uint32 *dst, const GLImage *src) {
+	const uint32 *texels = (const uint32 *)src->pixmap.getRawBuffer();
+	int dstWidth = MAX(src->xsize >> 1, 1);
+	int dstHeight = MAX(src->ysize >> 1, 1);
+	for (int y = 0; y < dstHeight; y++) {
+		int y0 = y * 2;
+		int y1 = MIN(y * 2 + 1, src->ysize - 1);
+		for (int x = 0; x < dstWidth; x++) {
+			int x0 = x * 2;
+			int x1 = MIN(x * 2 + 1, src->xsize - 1);
+			uint32 c00 = texels[gl_tiledTexelOffset(x0, y0, src->tilesPerLine)];
+			uint32 c10 = texels[gl_tiledTexelOffset(x1, y0, src->tilesPerLine)];
+			uint32 c01 = texels[gl_tiledTexelOffset(x0, y1, src->tilesPerLine)];
+			uint32 c11 = texels[gl_tiledTexelOffset(x1, y1, src->tilesPerLine)];
+			uint32 evenChannels = (c00 & 0x00FF00FF) + (c10 & 0x00FF00FF) + (c01 & 0x00FF00FF) + (c11 & 0x00FF00FF) + 0x00020002;
+			uint32 oddChannels = ((c00 >> 8) & 0x00FF00FF) + ((c10 >> 8) & 0x00FF00FF) + ((c01 >> 8) & 0x00FF00FF) + ((c11 >> 8) & 0x00FF00FF) + 0x00020002;
+			*dst++ = ((evenChannels >> 2) & 0x00FF00FF) | ((oddChannels << 6) & 0xFF00FF00);
+		}
+	}
+}
+
+static bool isMipmapFilter(int filter) {
+	return filter != TGL_NEAREST && filter != TGL_LINEAR;
+}
+
+// Builds the levels missing from the mip chain of the texture, if its minification
+// filter uses them. Uploads only store the level they are given, so textures which
+// are not mipmapped, or which are uploaded again before being drawn, never pay for it.
+void gl_buildMipmaps(GLTexture *t) {
+	if (!isMipmapFilter(t->minFilter) || t->levelCount == 0)
+		return;
+
+	while (t->levelCount < MAX_TEXTURE_LEVELS) {
+		const GLImage *im = &t->images[t->levelCount - 1];
+		if (im->xsize <= 1 && im->ysize <= 1)
+			break;
+		int width = MAX(im->xsize >> 1, 1);
+		int height = MAX(im->ysize >> 1, 1);
+		uint32 *pixels = new uint32[width * height];
+		downsampleImage(pixels, im);
+		storeTiledImage(&t->images[t->levelCount], im->pixmap.getFormat(), (const byte *)pixels, width, height);
+		delete[] pixels;
+		t->levelCount++;
+	}
+}
+
 void glInitTextures(GLContext *c) {
 	// textures
 	c->texture_2d_enabled = 0;
@@ -191,16 +268,12 @@ void glopTexImage2D(GLContext *c, GLParam *p) {
 		error("tglTexImage2D: combination of parameters not handled");
 	}
 
-	pixels1 = new byte[c->_textureSize * c->_textureSize * bytes];
-	if (pixels != NULL) {
-		if (width != c->_textureSize || height != c->_textureSize) {
-			// we use interpolation for better looking result
-			gl_resizeImage(pixels1, c->_textureSize, c->_textureSize, pixels, width, height);
-			width = c->_textureSize;
-			height = c->_textureSize;
-		} else {
-			memcpy(pixels1, pixels, c->_textureSize * c->_textureSize * bytes);
-		}
+	// Textures are stored with their own size, the rasterizer scales the texture coordinates.
+	pixels1 = new byte[width * height * bytes];
+	if (pixels == NULL) {
+		memset(pixels1, 0, width * height * bytes);
+	} else {
+		memcpy(pixels1, pixels, width * height * bytes);
 #if defined(SCUMM_BIG_ENDIAN)
 		if (type == TGL_UNSIGNED_INT_8_8_8_8_REV) {
 			for (int y = 0; y < height; y++) {
@@ -216,11 +289,14 @@ void glopTexImage2D(GLContext *c, GLParam *p) {
 
 	c->current_texture->versionNumber++;
 	im = &c->current_texture->images[level];
-	im->xsize = width;
-	im->ysize = height;
-	if (im->pixmap)
-		im->pixmap.free();
-	im->pixmap = Graphics::PixelBuffer(pf, pixels1);
+	storeTiledImage(im, pf, pixels1, width, height);
+	// A new first level makes the others stale, gl_buildMipmaps() rebuilds them when they
+	// are needed. Other levels only extend the chain when they follow its last level.
+	if (level == 0)
+		c->current_texture->levelCount = 1;
+	else if (level == c->current_texture->levelCount)
+		c->current_texture->levelCount++;
+	delete[] pixels1;
 
 	if (do_free_after_rgb2rgba) {
 		// pixels as been assigned to tmp.getRawBuffer() which was created with
@@ -248,7 +324,7 @@ error:
 }
 
 // TODO: not all tests are done
-void glopTexParameter(GLContext *, GLParam *p) {
+void glopTexParameter(GLContext *c, GLParam *p) {
 	int target = p[1].i;
 	int pname = p[2].i;
 	int param = p[3].i;
@@ -264,6 +340,27 @@ error:
 		if (param != TGL_REPEAT)
 			goto error;
 		break;
+	case TGL_TEXTURE_MIN_FILTER:
+		switch (param) {
+		case TGL_NEAREST:
+		case TGL_LINEAR:
+		case TGL_NEAREST_MIPMAP_NEAREST:
+		case TGL_NEAREST_MIPMAP_LINEAR:
+		case TGL_LINEAR_MIPMAP_NEAREST:
+		case TGL_LINEAR_MIPMAP_LINEAR:
+			c->current_texture->minFilter = param;
+			c->current_texture->versionNumber++;
+			break;
+		default:
+			goto error;
+		}
+		break;
+	case TGL_TEXTURE_MAG_FILTER:
+		if (param != TGL_NEAREST && param != TGL_LINEAR)
+			goto error;
+		c->current_texture->magFilter = param;
+		c->current_texture->versionNumber++;
+		break;
 	default:
 		;
 	}
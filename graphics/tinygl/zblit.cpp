@@ -41,7 +41,7 @@ Common::Rect rotateRectangle(int x, int y, int width, int height, int rotation,
 
 struct BlitImage {
 public:
-	BlitImage() : _isDisposed(false), _version(0), _binaryTransparent(false), _refcount(1) { }
+	BlitImage() : _isDisposed(false), _version(0), _binaryTransparent(false), _canBlendLines(false), _refcount(1) { }
 
 	void loadData(const Graphics::Surface &surface, uint32 colorKey, bool applyColorKey) {
 		const Graphics::PixelFormat textureFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
@@ -62,32 +62,69 @@ public:
 		// Create opaque lines data.
 		// A line of pixels can not wrap more that one line of the image, since it would break
 		// blitting of bitmaps with a non-zero x position.
+		// Lines are also split where pixels switch between opaque and translucent, so that
+		// opaque lines can always be copied as they are.
 		Graphics::PixelBuffer srcBuf = dataBuffer;
 		_lines.clear();
 		_binaryTransparent = true;
+		int lineDataSize = 0, blendDataSize = 0;
 		for (int y = 0; y < surface.h; y++) {
 			int start = -1;
-			for (int x = 0; x < surface.w; ++x) {
-				// We found a transparent pixel, so save a line from 'start' to the pixel before this.
-				uint8 r, g, b, a;
-				srcBuf.getARGBAt(x, a, r, g, b);
+			bool startOpaque = false;
+			for (int x = 0; x <= surface.w; ++x) {
+				// The end of the bitmap line is handled as a transparent pixel.
+				uint8 r, g, b, a = 0;
+				if (x < surface.w) {
+					srcBuf.getARGBAt(x, a, r, g, b);
+				}
 				if (a != 0 && a != 0xFF) {
 					_binaryTransparent = false;
 				}
-				if (a == 0 && start >= 0) {
-					_lines.push_back(Line(start, y, x - start, srcBuf.getRawBuffer(start), textureFormat));
+				// Save a line from 'start' to the pixel before this one when its kind changes.
+				if (start >= 0 && (a == 0 || (a == 0xFF) != startOpaque)) {
+					_lines.push_back(Line(start, y, x - start, startOpaque, lineDataSize, startOpaque ? -1 : blendDataSize));
+					lineDataSize += x - start;
+					if (!startOpaque)
+						blendDataSize += x - start;
 					start = -1;
-				} else if (a != 0 && start == -1) {
+				}
+				if (a != 0 && start == -1) {
 					start = x;
+					startOpaque = a == 0xFF;
 				}
 			}
-			// end of the bitmap line. if start is an actual pixel save the line.
-			if (start >= 0) {
-				_lines.push_back(Line(start, y, surface.w - start, srcBuf.getRawBuffer(start), textureFormat));
-			}
 			srcBuf.shiftBy(surface.w);
 		}
 
+		// Convert all the lines to the screen format, in a single buffer.
+		const Graphics::PixelFormat &screenFormat = TinyGL::gl_get_context()->fb->cmode;
+		_lineData.free();
+		_lineData.create(screenFormat, MAX(lineDataSize, 1), DisposeAfterUse::NO);
+		for (uint i = 0; i < _lines.size(); i++) {
+			const Line &l = _lines[i];
+			_lineData.copyBuffer(l._offset, l._y * surface.w + l._x, l._length, dataBuffer);
+		}
+
+		// Translucent lines are also stored premultiplied by their alpha for the blending kernel, which only
+		// supports screen formats with 8 bits per color channel stored in 32 bits.
+		_blendData.clear();
+		_canBlendLines = screenFormat.bytesPerPixel == 4 && screenFormat.rLoss == 0 && screenFormat.gLoss == 0 && screenFormat.bLoss == 0 &&
+				(screenFormat.rShift & 7) == 0 && (screenFormat.gShift & 7) == 0 && (screenFormat.bShift & 7) == 0;
+		if (_canBlendLines) {
+			const uint32 colorMask = screenFormat.RGBToColor(255, 255, 255) & ~screenFormat.ARGBToColor(255, 0, 0, 0);
+			_blendData.resize(blendDataSize);
+			for (uint i = 0; i < _lines.size(); i++) {
+				const Line &l = _lines[i];
+				if (l._opaque)
+					continue;
+				for (int x = 0; x < l._length; x++) {
+					uint8 r, g, b, a;
+					dataBuffer.getARGBAt(l._y * surface.w + l._x + x, a, r, g, b);
+					_blendData[l._blendOffset + x] = screenFormat.RGBToColor((r * a) >> 8, (g * a) >> 8, (b * a) >> 8) & colorMask;
+				}
+			}
+		}
+
 		_version++;
 	}
 
@@ -97,33 +134,20 @@ public:
 
 	~BlitImage() {
 		_surface.free();
+		_lineData.free();
 	}
 
 	struct Line {
 		int _x;
 		int _y;
 		int _length;
-		byte *_pixels;
-		Graphics::PixelBuffer _buf; // This is needed for the conversion.
-
-		Line() : _x(0), _y(0), _length(0), _pixels(nullptr) { }
-		Line(int x, int y, int length, byte *pixels, const Graphics::PixelFormat &textureFormat) : _buf(TinyGL::gl_get_context()->fb->cmode, length, DisposeAfterUse::NO),
-					_x(x), _y(y), _length(length) {
-			// Performing texture to screen conversion.
-			Graphics::PixelBuffer srcBuf(textureFormat, pixels);
-			_buf.copyBuffer(0, 0, length, srcBuf);
-			_pixels = _buf.getRawBuffer();
-		}
+		bool _opaque;
+		int _offset; // Offset of the pixels in the line data.
+		int _blendOffset; // Offset of the premultiplied pixels of translucent lines in the blend data.
 
-		Line(const Line& other) : _buf(other._buf.getFormat(), other._length, DisposeAfterUse::NO),
-					_x(other._x), _y(other._y), _length(other._length){
-			_buf.copyBuffer(0, 0, _length, other._buf);
-			_pixels = _buf.getRawBuffer();
-		}
-
-		~Line() {
-			_buf.free();
-		}
+		Line() : _x(0), _y(0), _length(0), _opaque(false), _offset(0), _blendOffset(-1) { }
+		Line(int x, int y, int length, bool opaque, int offset, int blendOffset) : _x(x), _y(y), _length(length),
+					_opaque(opaque), _offset(offset), _blendOffset(blendOffset) { }
 	};
 
 	FORCEINLINE bool clipBlitImage(TinyGL::GLContext *c, int &srcX, int &srcY, int &srcWidth, int &srcHeight, int &width, int &height, int &dstX, int &dstY, int &clampWidth, int &clampHeight) {
@@ -200,6 +224,9 @@ public:
 		}
 	}
 
+	// Blends a translucent line with SRC_ALPHA, ONE_MINUS_SRC_ALPHA, giving the same result as FrameBuffer::writePixel.
+	void blendLine(const Line &l, int skipStart, int length, byte *dst, const Graphics::PixelFormat &dstFormat) const;
+
 	template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
 	FORCEINLINE void tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
@@ -252,7 +279,10 @@ public:
 private:
 	bool _isDisposed;
 	bool _binaryTransparent;
+	bool _canBlendLines;
 	Common::Array<Line> _lines;
+	Graphics::PixelBuffer _lineData;
+	Common::Array<uint32> _blendData;
 	Graphics::Surface _surface;
 	int _version;
 	int _refcount;
@@ -290,6 +320,23 @@ void tglDeleteBlitImage(BlitImage *blitImage) {
 	}
 }
 
+void BlitImage::blendLine(const Line &l, int skipStart, int length, byte *dst, const Graphics::PixelFormat &dstFormat) const {
+	const uint32 alphaMask = dstFormat.ARGBToColor(255, 0, 0, 0);
+	const uint32 colorMask = dstFormat.RGBToColor(255, 255, 255) & ~alphaMask;
+	const uint32 *src = &_blendData[l._blendOffset + skipStart];
+	const uint32 *srcAlpha = (const uint32 *)_surface.getBasePtr(l._x + skipStart, l._y);
+	uint32 *dstPixels = (uint32 *)dst;
+	for (int x = 0; x < length; x++) {
+		// Scale two channels at once, each product fits in 16 bits so they can not overlap.
+		uint32 invAlpha = 255 - (FROM_LE_32(srcAlpha[x]) >> 24);
+		uint32 dstColor = FROM_LE_32(dstPixels[x]);
+		uint32 scaled = (((dstColor & 0x00FF00FF) * invAlpha >> 8) & 0x00FF00FF) |
+			(((dstColor >> 8) & 0x00FF00FF) * invAlpha & 0xFF00FF00);
+		// Premultiplied source and scaled destination never add up to more than 255, so there is nothing to clamp.
+		dstPixels[x] = TO_LE_32((src[x] + (scaled & colorMask)) | alphaMask);
+	}
+}
+
 // This function uses RLE encoding to skip transparent bitmap parts
 // This blit only supports tinting but it will fall back to simpleBlit
 // if flipping is required (or anything more complex than that, including rotationd and scaling).
@@ -329,26 +376,22 @@ FORCEINLINE void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, i
 				length -= skipStart;
 				int skipEnd   = (l._x + l._length > maxX) ? (l._x + l._length - maxX) : 0;
 				length -= skipEnd;
-				if (kDisableColoring && (kEnableAlphaBlending == false || kDisableBlending)) {
+				if (kDisableColoring) {
 					memcpy(dstBuf.getRawBuffer((l._y - srcY) * c->fb->xsize + MAX(l._x - srcX, 0)),
-						l._pixels + skipStart * kBytesPerPixel, length * kBytesPerPixel);
+						_lineData.getRawBuffer(l._offset + skipStart), length * kBytesPerPixel);
 				} else {
 					int xStart = MAX(l._x - srcX, 0);
-					if (kDisableColoring) {
-						dstBuf.copyBuffer(xStart + (l._y - srcY) * c->fb->xsize, skipStart, length, l._buf);
-					} else {
-						for(int x = xStart; x < xStart + length; x++) {
-							byte aDst, rDst, gDst, bDst;
-							srcBuf.getARGBAt((l._y - srcY) * _surface.w + x, aDst, rDst, gDst, bDst);
-							c->fb->writePixel((dstX + x) + (dstY + (l._y - srcY)) * c->fb->xsize, aDst * aTint, rDst * rTint, gDst * gTint, bDst * bTint);
-						}
+					for(int x = xStart; x < xStart + length; x++) {
+						byte aDst, rDst, gDst, bDst;
+						srcBuf.getARGBAt((l._y - srcY) * _surface.w + x, aDst, rDst, gDst, bDst);
+						c->fb->writePixel((dstX + x) + (dstY + (l._y - srcY)) * c->fb->xsize, aDst * aTint, rDst * rTint, gDst * gTint, bDst * bTint);
 					}
-
 				}
 			}
 			lineIndex++;
 		}
-	} else { // Otherwise can use setPixel in some cases which speeds up things quite a bit
+	} else { // Otherwise opaque lines can be copied and translucent ones blended in a single pass
+		bool blendLines = _canBlendLines && !c->fb->isAlphaTestEnabled();
 		while (lineIndex < _lines.size() && _lines[lineIndex]._y < maxY) {
 			const BlitImage::Line &l = _lines[lineIndex];
 			if (l._x < maxX && l._x + l._length > srcX) {
@@ -357,9 +400,11 @@ FORCEINLINE void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, i
 				length -= skipStart;
 				int skipEnd   = (l._x + l._length > maxX) ? (l._x + l._length - maxX) : 0;
 				length -= skipEnd;
-				if (kDisableColoring && (kEnableAlphaBlending == false || kDisableBlending)) {
+				if (kDisableColoring && l._opaque) {
 					memcpy(dstBuf.getRawBuffer((l._y - srcY) * c->fb->xsize + MAX(l._x - srcX, 0)),
-						l._pixels + skipStart * kBytesPerPixel, length * kBytesPerPixel);
+						_lineData.getRawBuffer(l._offset + skipStart), length * kBytesPerPixel);
+				} else if (kDisableColoring && blendLines) {
+					blendLine(l, skipStart, length, dstBuf.getRawBuffer((l._y - srcY) * c->fb->xsize + MAX(l._x - srcX, 0)), c->fb->cmode);
 				} else {
 					int xStart = MAX(l._x - srcX, 0);
 					for(int x = xStart; x < xStart + length; x++) {
@@ -588,7 +633,7 @@ FORCEINLINE void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int
 				dy = sh - dy;
 			}
 			
-			if ((dx >= 0) && (dy >= 0) && (dx < srcWidth) && (dy < srcHeight)) {
+			if ((dx >= 0) && (dy >= 0) && (dx < srcWidth) && (dy < srcHeight) && c->_scissorRect.contains(dstX + x, dstY + y)) {
 				srcBuf.getARGBAt(dy * _surface.w + dx, aDst, rDst, gDst, bDst);
 				if (kDisableColoring) {
 					if (kDisableBlending && aDst != 0) {
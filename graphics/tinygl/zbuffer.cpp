@@ -104,6 +104,7 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &fra
 	}
 
 	this->current_texture = NULL;
+	this->_textureFiltering = false;
 	this->shadow_mask_buf = NULL;
 
 	this->buffer.pbuf = this->pbuf.getRawBuffer();
@@ -306,8 +307,9 @@ void FrameBuffer::clearOffscreenBuffer(Buffer *buf) {
 	buf->used = false;
 }
 
-void FrameBuffer::setTexture(const Graphics::PixelBuffer &texture) {
+void FrameBuffer::setTexture(const GLTexture *texture, bool filtering) {
 	current_texture = texture;
+	_textureFiltering = filtering;
 }
 
 } // end of namespace TinyGL
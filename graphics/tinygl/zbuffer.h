@@ -35,6 +35,8 @@
 
 namespace TinyGL {
 
+struct GLTexture;
+
 // Z buffer
 
 #define ZB_Z_BITS 16
@@ -73,6 +75,32 @@ static const int DRAW_SMOOTH = 2;
 static const int DRAW_SHADOW_MASK = 3;
 static const int DRAW_SHADOW = 4;
 
+// Depth and alpha test function template parameter telling to read the function from the frame buffer state.
+static const int TEST_FUNC_RUNTIME = -1;
+
+template <int kFunc, typename T>
+FORCEINLINE static bool testFunction(int func, T value, T reference) {
+	switch (kFunc == TEST_FUNC_RUNTIME ? func : kFunc) {
+	case TGL_NEVER:
+		break;
+	case TGL_LESS:
+		return value < reference;
+	case TGL_EQUAL:
+		return value == reference;
+	case TGL_LEQUAL:
+		return value <= reference;
+	case TGL_GREATER:
+		return value > reference;
+	case TGL_NOTEQUAL:
+		return value != reference;
+	case TGL_GEQUAL:
+		return value >= reference;
+	case TGL_ALWAYS:
+		return true;
+	}
+	return false;
+}
+
 struct Buffer {
 	byte *pbuf;
 	unsigned int *zbuf;
@@ -121,77 +149,27 @@ struct FrameBuffer {
 	}
 
 	FORCEINLINE bool compareDepth(unsigned int &zSrc, unsigned int &zDst) {
-		if (!_depthTestEnabled)
-			return true;
+		return compareDepth<TEST_FUNC_RUNTIME>(zSrc, zDst);
+	}
 
-		switch (_depthFunc) {
-		case TGL_NEVER:
-			break;
-		case TGL_LESS:
-			if (zDst < zSrc)
-				return true;
-			break;
-		case TGL_EQUAL:
-			if (zDst == zSrc)
-				return true;
-			break;
-		case TGL_LEQUAL:
-			if (zDst <= zSrc)
-				return true;
-			break;
-		case TGL_GREATER:
-			if (zDst > zSrc)
-				return true;
-			break;
-		case TGL_NOTEQUAL:
-			if (zDst != zSrc)
-				return true;
-			break;
-		case TGL_GEQUAL:
-			if (zDst >= zSrc)
-				return true;
-			break;
-		case TGL_ALWAYS:
+	template <int kDepthFunc>
+	FORCEINLINE bool compareDepth(unsigned int zSrc, unsigned int zDst) {
+		if (kDepthFunc == TEST_FUNC_RUNTIME && !_depthTestEnabled)
 			return true;
-		}
-		return false;
+
+		return testFunction<kDepthFunc>(_depthFunc, zDst, zSrc);
 	}
 
 	FORCEINLINE bool checkAlphaTest(byte aSrc) {
-		if (!_alphaTestEnabled)
-			return true;
+		return checkAlphaTest<TEST_FUNC_RUNTIME>(aSrc);
+	}
 
-		switch (_alphaTestFunc) {
-		case TGL_NEVER:
-			break;
-		case TGL_LESS:
-			if (aSrc < _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_EQUAL:
-			if (aSrc == _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_LEQUAL:
-			if (aSrc <= _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_GREATER:
-			if (aSrc > _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_NOTEQUAL:
-			if (aSrc != _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_GEQUAL:
-			if (aSrc >= _alphaTestRefVal)
-				return true;
-			break;
-		case TGL_ALWAYS:
+	template <int kAlphaTestFunc>
+	FORCEINLINE bool checkAlphaTest(byte aSrc) {
+		if (kAlphaTestFunc == TEST_FUNC_RUNTIME && !_alphaTestEnabled)
 			return true;
-		}
-		return false;
+
+		return testFunction<kAlphaTestFunc>(_alphaTestFunc, (int)aSrc, _alphaTestRefVal);
 	}
 
 	template <bool kEnableAlphaTest, bool kBlendingEnabled>
@@ -263,10 +241,17 @@ struct FrameBuffer {
 
 	template <bool kEnableAlphaTest, bool kBlendingEnabled, bool kDepthWrite>
 	FORCEINLINE void writePixel(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc, unsigned int z) {
-		if (kEnableAlphaTest) {
-			if (!checkAlphaTest(aSrc))
-				return;
-		}
+		writeFragment<kEnableAlphaTest ? TEST_FUNC_RUNTIME : TGL_ALWAYS, kBlendingEnabled, kDepthWrite>(pixel, aSrc, rSrc, gSrc, bSrc, z);
+	}
+
+	/**
+	* Writes a pixel which already passed the depth test.
+	* kAlphaTestFunc is the alpha test function, TGL_ALWAYS if the alpha test is disabled.
+	*/
+	template <int kAlphaTestFunc, bool kBlendingEnabled, bool kDepthWrite>
+	FORCEINLINE void writeFragment(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc, unsigned int z) {
+		if (!checkAlphaTest<kAlphaTestFunc>(aSrc))
+			return;
 		if (kDepthWrite) {
 			_zbuf[pixel] = z;
 		}
@@ -423,15 +408,18 @@ struct FrameBuffer {
 	void blitOffscreenBuffer(Buffer *buffer);
 	void selectOffscreenBuffer(Buffer *buffer);
 	void clearOffscreenBuffer(Buffer *buffer);
-	void setTexture(const Graphics::PixelBuffer &texture);
+	void setTexture(const GLTexture *texture, bool filtering);
+
+	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor, bool kEnableBlending>
+	void fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2);
 
-	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, bool enableAlphaTest, bool kEnableScissor, bool enableBlending>
+	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor>
 	void fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2);
 
-	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, bool enableAlphaTest, bool kEnableScissor>
+	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc>
 	void fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2);
 
-	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, bool enableAlphaTest>
+	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc>
 	void fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2);
 
 	template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite>
@@ -481,9 +469,9 @@ struct FrameBuffer {
 
 	unsigned char *dctable;
 	int *ctable;
-	Graphics::PixelBuffer current_texture;
+	const GLTexture *current_texture;
+	bool _textureFiltering;
 	int _textureSize;
-	int _textureSizeMask;
 
 	FORCEINLINE bool isBlendingEnabled() const { return _blendingEnabled; }
 	FORCEINLINE void getBlendingFactors(int &sourceFactor, int &destinationFactor) const { sourceFactor = _sourceBlendingFactor; destinationFactor = _destinationBlendingFactor; }
@@ -32,11 +32,44 @@
 #include "common/debug.h"
 #include "common/math.h"
 
+// FNV-1a, applied on 32 bit words.
+static inline uint32 _hashValue(uint32 hash, uint32 value) {
+	return (hash ^ value) * 16777619;
+}
+
+static inline uint32 _hashValue(uint32 hash, int value) {
+	return _hashValue(hash, (uint32)value);
+}
+
+static inline uint32 _hashValue(uint32 hash, float value) {
+	uint32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return _hashValue(hash, bits);
+}
+
+static inline uint32 _hashValue(uint32 hash, const void *pointer) {
+	const byte *bytes = (const byte *)&pointer;
+	for (uint i = 0; i < sizeof(pointer); i++) {
+		hash = _hashValue(hash, (uint32)bytes[i]);
+	}
+	return hash;
+}
+
+template <int kSize>
+static inline uint32 _hashVector(uint32 hash, const float (&v)[kSize]) {
+	for (int i = 0; i < kSize; i++) {
+		hash = _hashValue(hash, v[i]);
+	}
+	return hash;
+}
+
+static const uint32 kHashSeed = 2166136261u;
+
 namespace TinyGL {
 
 void tglIssueDrawCall(Graphics::DrawCall *drawCall) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
-	if (c->_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
+	if ((c->_enableDirtyRectangles || c->_enableTiledRendering) && drawCall->getDirtyRegion().isEmpty())
 		return;
 	c->_drawCallsQueue.push_back(drawCall);
 }
@@ -102,7 +135,7 @@ void tglDisposeResources(TinyGL::GLContext *c) {
 }
 
 void tglDisposeDrawCallLists(TinyGL::GLContext *c) {
-	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::Array<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 	for (DrawCallIterator it = c->_previousFrameDrawCallsQueue.begin(); it != c->_previousFrameDrawCallsQueue.end(); ++it) {
 		delete *it;
 	}
@@ -113,94 +146,292 @@ void tglDisposeDrawCallLists(TinyGL::GLContext *c) {
 	c->_drawCallsQueue.clear();
 }
 
-static inline void _appendDirtyRectangle(const Graphics::DrawCall &call, Common::List<DirtyRectangle> &rectangles, int r, int g, int b) {
+static inline void _appendDirtyRectangle(const Graphics::DrawCall &call, Common::Array<DirtyRectangle> &rectangles, int r, int g, int b) {
 	Common::Rect dirty_region = call.getDirtyRegion();
-	if (rectangles.empty() || dirty_region != (*rectangles.end()).rectangle)
+	if (rectangles.empty() || dirty_region != rectangles.back().rectangle)
 		rectangles.push_back(DirtyRectangle(dirty_region, r, g, b));
 }
 
-static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
-	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
-	typedef Common::List<TinyGL::DirtyRectangle>::iterator RectangleIterator;
+// Uniform grid over the render area: each cell references the rectangles overlapping it, so that
+// only rectangles sharing a cell need to be tested against each other.
+class DirtyRectangleGrid {
+public:
+	DirtyRectangleGrid(const Common::Rect &area) : _area(area) {
+		_columns = MAX(1, (area.width() + kCellSize - 1) >> kCellShift);
+		_rows = MAX(1, (area.height() + kCellSize - 1) >> kCellShift);
+	}
+
+	void build(const Common::Array<DirtyRectangle> &rectangles) {
+		// Cells are stored contiguously: _cellStart[i] is the offset of cell i in _cellEntries.
+		_cellStart.resize(0);
+		_cellStart.resize(_columns * _rows + 1);
+		for (uint i = 0; i < _cellStart.size(); i++) {
+			_cellStart[i] = 0;
+		}
 
-	Common::List<DirtyRectangle> rectangles;
+		for (uint i = 0; i < rectangles.size(); i++) {
+			int x0, y0, x1, y1;
+			getCellRange(rectangles[i].rectangle, x0, y0, x1, y1);
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					_cellStart[y * _columns + x + 1]++;
+				}
+			}
+		}
 
-	DrawCallIterator itFrame = c->_drawCallsQueue.begin();
-	DrawCallIterator endFrame = c->_drawCallsQueue.end();
-	DrawCallIterator itPrevFrame = c->_previousFrameDrawCallsQueue.begin();
-	DrawCallIterator endPrevFrame = c->_previousFrameDrawCallsQueue.end();
+		for (uint i = 1; i < _cellStart.size(); i++) {
+			_cellStart[i] += _cellStart[i - 1];
+		}
 
-	// Compare draw calls.
-	for ( ; itPrevFrame != endPrevFrame && itFrame != endFrame;
-		++itPrevFrame, ++itFrame) {
-			const Graphics::DrawCall &currentCall = **itFrame;
-			const Graphics::DrawCall &previousCall = **itPrevFrame;
+		_cellEntries.resize(_cellStart.back());
+		_cellFill.resize(_columns * _rows);
+		for (uint i = 0; i < _cellFill.size(); i++) {
+			_cellFill[i] = _cellStart[i];
+		}
 
-			if (previousCall != currentCall) {
-				_appendDirtyRectangle(previousCall, rectangles, 255, 255, 255);
-				_appendDirtyRectangle(currentCall, rectangles, 255, 0, 0);
+		for (uint i = 0; i < rectangles.size(); i++) {
+			int x0, y0, x1, y1;
+			getCellRange(rectangles[i].rectangle, x0, y0, x1, y1);
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					_cellEntries[_cellFill[y * _columns + x]++] = i;
+				}
 			}
+		}
 	}
 
-	for ( ; itPrevFrame != endPrevFrame; ++itPrevFrame) {
-		_appendDirtyRectangle(**itPrevFrame, rectangles, 255, 255, 255);
+	void getCellRange(const Common::Rect &rect, int &x0, int &y0, int &x1, int &y1) const {
+		x0 = CLIP((rect.left - _area.left) >> kCellShift, 0, _columns - 1);
+		x1 = CLIP((rect.right - 1 - _area.left) >> kCellShift, 0, _columns - 1);
+		y0 = CLIP((rect.top - _area.top) >> kCellShift, 0, _rows - 1);
+		y1 = CLIP((rect.bottom - 1 - _area.top) >> kCellShift, 0, _rows - 1);
 	}
 
-	for ( ; itFrame != endFrame; ++itFrame) {
-		_appendDirtyRectangle(**itFrame, rectangles, 255, 0, 0);
-	}
+	int getColumns() const { return _columns; }
+	int getRows() const { return _rows; }
 
-	// This loop increases outer rectangle coordinates to favor merging of adjacent rectangles.
-	for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
-		(*it).rectangle.right++;
-		(*it).rectangle.bottom++;
+	const int *cellBegin(int x, int y) const { return _cellEntries.begin() + _cellStart[y * _columns + x]; }
+	const int *cellEnd(int x, int y) const { return _cellEntries.begin() + _cellStart[y * _columns + x + 1]; }
+
+private:
+	static const int kCellShift = 6;
+	static const int kCellSize = 1 << kCellShift;
+
+	Common::Rect _area;
+	int _columns, _rows;
+	Common::Array<int> _cellStart;
+	Common::Array<int> _cellFill;
+	Common::Array<int> _cellEntries;
+};
+
+static int _findMergedRectangle(Common::Array<int> &parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
 	}
+	return i;
+}
 
-	// Merge coalesce dirty rects.
-	bool restartMerge;
+// Coalesces the rectangles until none of them intersects another one.
+// Each pass groups the rectangles connected by an intersection, which are found through the grid,
+// and replaces every group by its bounding box. Since bounding boxes can overlap rectangles that
+// were not part of the group, passes are repeated until nothing is merged anymore.
+static void _mergeDirtyRectangles(Common::Array<DirtyRectangle> &rectangles, DirtyRectangleGrid &grid) {
+	Common::Array<int> parent, index;
+	bool merged;
 	do {
-		restartMerge = false;
-		for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-			for (RectangleIterator it2 = rectangles.begin(); it2 != rectangles.end();) {
-				if (it1 != it2) {
-					if ((*it1).rectangle.intersects((*it2).rectangle)) {
-						(*it1).rectangle.extend((*it2).rectangle);
-						it2 = rectangles.erase(it2);
-						restartMerge = true;
-					} else {
-						++it2;
+		merged = false;
+		grid.build(rectangles);
+
+		parent.resize(rectangles.size());
+		for (uint i = 0; i < rectangles.size(); i++) {
+			parent[i] = i;
+		}
+
+		for (int y = 0; y < grid.getRows(); y++) {
+			for (int x = 0; x < grid.getColumns(); x++) {
+				for (const int *it1 = grid.cellBegin(x, y); it1 != grid.cellEnd(x, y); ++it1) {
+					for (const int *it2 = it1 + 1; it2 != grid.cellEnd(x, y); ++it2) {
+						if (!rectangles[*it1].rectangle.intersects(rectangles[*it2].rectangle))
+							continue;
+						int root1 = _findMergedRectangle(parent, *it1);
+						int root2 = _findMergedRectangle(parent, *it2);
+						if (root1 != root2) {
+							// The oldest rectangle of the group keeps representing it.
+							parent[MAX(root1, root2)] = MIN(root1, root2);
+							merged = true;
+						}
 					}
+				}
+			}
+		}
+
+		if (merged) {
+			uint count = 0;
+			index.resize(rectangles.size());
+			for (uint i = 0; i < rectangles.size(); i++) {
+				int root = _findMergedRectangle(parent, i);
+				if (root == (int)i) {
+					index[i] = count;
+					rectangles[count++] = rectangles[i];
 				} else {
-					++it2;
+					// Roots always come before the other rectangles of their group, so they were already moved.
+					rectangles[index[root]].rectangle.extend(rectangles[i].rectangle);
 				}
 			}
+			rectangles.resize(count);
 		}
-	} while(restartMerge);
+	} while (merged);
+}
 
-	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
-		RectangleIterator it2 = it1;
-		it2++;
-		while (it2 != rectangles.end()) {
-			if ((*it1).rectangle.contains((*it2).rectangle)) {
-				it2 = rectangles.erase(it2);
+struct DrawCallHashEntry {
+	uint32 hash;
+	int index;
+
+	bool operator<(const DrawCallHashEntry &other) const {
+		return hash < other.hash || (hash == other.hash && index < other.index);
+	}
+};
+
+// Aligns the draw calls of two frames. Matched calls are the same in both frames and keep the same
+// relative order, so any pixel only covered by matched calls is unchanged from the previous frame.
+// Common leading and trailing calls are matched first; each remaining current call is then matched
+// with the first equal previous call that follows the last match, found by hash through a sorted
+// index. An inserted or removed call thus only dirties its own region instead of shifting every
+// following comparison.
+static void _matchDrawCalls(const Common::Array<Graphics::DrawCall *> &previousFrame, const Common::Array<Graphics::DrawCall *> &currentFrame,
+							Common::Array<bool> &previousMatched, Common::Array<bool> &currentMatched) {
+	previousMatched.resize(previousFrame.size());
+	for (uint i = 0; i < previousMatched.size(); i++) {
+		previousMatched[i] = false;
+	}
+	currentMatched.resize(currentFrame.size());
+	for (uint i = 0; i < currentMatched.size(); i++) {
+		currentMatched[i] = false;
+	}
+
+	int previousBegin = 0, previousEnd = previousFrame.size();
+	int currentBegin = 0, currentEnd = currentFrame.size();
+
+	while (previousBegin < previousEnd && currentBegin < currentEnd &&
+			previousFrame[previousBegin]->getHash() == currentFrame[currentBegin]->getHash() &&
+			*previousFrame[previousBegin] == *currentFrame[currentBegin]) {
+		previousMatched[previousBegin++] = true;
+		currentMatched[currentBegin++] = true;
+	}
+
+	while (previousBegin < previousEnd && currentBegin < currentEnd &&
+			previousFrame[previousEnd - 1]->getHash() == currentFrame[currentEnd - 1]->getHash() &&
+			*previousFrame[previousEnd - 1] == *currentFrame[currentEnd - 1]) {
+		previousMatched[--previousEnd] = true;
+		currentMatched[--currentEnd] = true;
+	}
+
+	if (previousBegin == previousEnd || currentBegin == currentEnd)
+		return;
+
+	Common::Array<DrawCallHashEntry> previousHashes;
+	previousHashes.resize(previousEnd - previousBegin);
+	for (int i = previousBegin; i < previousEnd; i++) {
+		previousHashes[i - previousBegin].hash = previousFrame[i]->getHash();
+		previousHashes[i - previousBegin].index = i;
+	}
+	Common::sort(previousHashes.begin(), previousHashes.end());
+
+	int lastMatch = previousBegin - 1;
+	for (int i = currentBegin; i < currentEnd; i++) {
+		DrawCallHashEntry key;
+		key.hash = currentFrame[i]->getHash();
+		key.index = lastMatch + 1;
+
+		// Find the first entry not smaller than the key.
+		uint low = 0, high = previousHashes.size();
+		while (low < high) {
+			uint middle = (low + high) / 2;
+			if (previousHashes[middle] < key) {
+				low = middle + 1;
 			} else {
-				++it2;
+				high = middle;
+			}
+		}
+
+		for (; low < previousHashes.size() && previousHashes[low].hash == key.hash; low++) {
+			int previousIndex = previousHashes[low].index;
+			if (*previousFrame[previousIndex] == *currentFrame[i]) {
+				previousMatched[previousIndex] = true;
+				currentMatched[i] = true;
+				lastMatch = previousIndex;
+				break;
 			}
 		}
 	}
+}
+
+static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
+	typedef Common::Array<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::Array<TinyGL::DirtyRectangle>::iterator RectangleIterator;
+
+	Common::Array<DirtyRectangle> rectangles;
+
+	const Common::Array<Graphics::DrawCall *> &previousFrame = c->_previousFrameDrawCallsQueue;
+	const Common::Array<Graphics::DrawCall *> &currentFrame = c->_drawCallsQueue;
+
+	// Compare draw calls: only the calls that could not be matched with a call of the other frame are dirty.
+	Common::Array<bool> previousMatched, currentMatched;
+	_matchDrawCalls(previousFrame, currentFrame, previousMatched, currentMatched);
+
+	for (uint i = 0; i < previousFrame.size(); i++) {
+		if (!previousMatched[i])
+			_appendDirtyRectangle(*previousFrame[i], rectangles, 255, 255, 255);
+	}
+
+	for (uint i = 0; i < currentFrame.size(); i++) {
+		if (!currentMatched[i])
+			_appendDirtyRectangle(*currentFrame[i], rectangles, 255, 0, 0);
+	}
+
+	// This loop increases outer rectangle coordinates to favor merging of adjacent rectangles.
+	for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
+		(*it).rectangle.right++;
+		(*it).rectangle.bottom++;
+	}
+
+	// Merge coalesce dirty rects.
+	DirtyRectangleGrid grid(c->renderRect);
+	_mergeDirtyRectangles(rectangles, grid);
 
 	for (RectangleIterator it1 = rectangles.begin(); it1 != rectangles.end(); ++it1) {
 		(*it1).rectangle.clip(c->renderRect);
 	}
 
 	if (!rectangles.empty()) {
+		// Merged rectangles do not overlap, so each draw call only needs to look at the
+		// rectangles referenced by the cells under its dirty region.
+		grid.build(rectangles);
+		Common::Array<uint> lastDrawCall;
+		lastDrawCall.resize(rectangles.size());
+		for (uint i = 0; i < lastDrawCall.size(); i++) {
+			lastDrawCall[i] = 0;
+		}
+
 		// Execute draw calls.
+		uint drawCallIndex = 0;
 		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
 			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+			int x0, y0, x1, y1;
+			grid.getCellRange(drawCallRegion, x0, y0, x1, y1);
+			drawCallIndex++;
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					for (const int *itRect = grid.cellBegin(x, y); itRect != grid.cellEnd(x, y); ++itRect) {
+						if (lastDrawCall[*itRect] == drawCallIndex)
+							continue;
+						lastDrawCall[*itRect] = drawCallIndex;
+						const Common::Rect &dirtyRegion = rectangles[*itRect].rectangle;
+						if (dirtyRegion.intersects(drawCallRegion)) {
+							(*it)->execute(dirtyRegion, true);
+						}
+					}
 				}
 			}
 		}
@@ -224,14 +455,13 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 #endif
 	}
 
-	// Dispose not necessary draw calls.
+	// Dispose not necessary draw calls: their memory is released when their allocator is reset.
 	for (DrawCallIterator it = c->_previousFrameDrawCallsQueue.begin(); it != c->_previousFrameDrawCallsQueue.end(); ++it) {
 		delete *it;
 	}
 
-	c->_previousFrameDrawCallsQueue = c->_drawCallsQueue;
-	c->_drawCallsQueue.clear();
-
+	c->_previousFrameDrawCallsQueue.assign(c->_drawCallsQueue.begin(), c->_drawCallsQueue.end());
+	c->_drawCallsQueue.resize(0);
 
 	tglDisposeResources(c);
 
@@ -240,14 +470,79 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 }
 
 static void tglPresentBufferSimple(TinyGL::GLContext *c) {
-	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::Array<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 
 	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
 		(*it)->execute(true);
 		delete *it;
 	}
 
-	c->_drawCallsQueue.clear();
+	c->_drawCallsQueue.resize(0);
+
+	tglDisposeResources(c);
+
+	c->_drawCallAllocator[c->_currentAllocatorIndex].reset();
+}
+
+// Splits the frame buffer in tiles and bins every draw call in the tiles touched by its dirty region.
+// Each tile is then replayed in submission order, clipped to the tile: since tiles do not overlap and
+// every primitive honours the scissor rectangle, the result is identical to the serial replay while
+// each tile only touches a small, cache resident, part of the color and z buffers.
+// The bins of different tiles are independent from each other and could be replayed concurrently.
+static void tglPresentBufferTiled(TinyGL::GLContext *c) {
+	typedef Common::Array<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+
+	const Common::Rect &renderRect = c->renderRect;
+	int tilesX = (renderRect.width() + c->_tileWidth - 1) / c->_tileWidth;
+	int tilesY = (renderRect.height() + c->_tileHeight - 1) / c->_tileHeight;
+	int tileCount = tilesX * tilesY;
+
+	if ((int)c->_tileBins.size() != tileCount) {
+		c->_tileBins.clear();
+		c->_tileBins.resize(tileCount);
+	}
+
+	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+		Common::Rect region = (*it)->getDirtyRegion();
+		region.clip(renderRect);
+		if (region.isEmpty())
+			continue;
+
+		int firstTileX = (region.left - renderRect.left) / c->_tileWidth;
+		int lastTileX = (region.right - 1 - renderRect.left) / c->_tileWidth;
+		int firstTileY = (region.top - renderRect.top) / c->_tileHeight;
+		int lastTileY = (region.bottom - 1 - renderRect.top) / c->_tileHeight;
+		for (int y = firstTileY; y <= lastTileY; y++) {
+			for (int x = firstTileX; x <= lastTileX; x++) {
+				c->_tileBins[y * tilesX + x].push_back(*it);
+			}
+		}
+	}
+
+	for (int y = 0; y < tilesY; y++) {
+		for (int x = 0; x < tilesX; x++) {
+			Common::Array<Graphics::DrawCall *> &bin = c->_tileBins[y * tilesX + x];
+			if (bin.empty())
+				continue;
+
+			Common::Rect tileRect(c->_tileWidth, c->_tileHeight);
+			tileRect.translate(renderRect.left + x * c->_tileWidth, renderRect.top + y * c->_tileHeight);
+			tileRect.clip(renderRect);
+
+			for (uint i = 0; i < bin.size(); i++) {
+				bin[i]->execute(tileRect, true);
+			}
+
+			// Keep the storage of the bin for the next frame.
+			bin.resize(0);
+		}
+	}
+
+	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+		delete *it;
+	}
+
+	c->_drawCallsQueue.resize(0);
 
 	tglDisposeResources(c);
 
@@ -258,6 +553,8 @@ void tglPresentBuffer() {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	if (c->_enableDirtyRectangles) {
 		tglPresentBufferDirtyRects(c);
+	} else if (c->_enableTiledRendering) {
+		tglPresentBufferTiled(c);
 	} else {
 		tglPresentBufferSimple(c);
 	}
@@ -287,7 +584,17 @@ bool DrawCall::operator==(const DrawCall &other) const {
 	}
 }
 
-RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization) {
+RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization), _indexCount(0), _indices(nullptr) {
+	init();
+}
+
+RasterizationDrawCall::RasterizationDrawCall(const int *indices, int indexCount) : DrawCall(DrawCall_Rasterization), _indexCount(indexCount) {
+	_indices = (int *) ::Internal::allocateFrame(_indexCount * sizeof(int));
+	memcpy(_indices, indices, sizeof(int) * _indexCount);
+	init();
+}
+
+void RasterizationDrawCall::init() {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	_vertexCount = c->vertex_cnt;
 	_vertex = (TinyGL::GLVertex *) ::Internal::allocateFrame(_vertexCount * sizeof(TinyGL::GLVertex));
@@ -295,9 +602,12 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(TinyGL::GLVertex) * _vertexCount);
 	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
+	if (c->_enableDirtyRectangles) {
+		computeHash();
+	}
 }
 
 void RasterizationDrawCall::computeDirtyRegion() {
@@ -333,6 +643,66 @@ void RasterizationDrawCall::computeDirtyRegion() {
 	}
 }
 
+void RasterizationDrawCall::computeHash() {
+	uint32 hash = kHashSeed;
+	hash = _hashValue(hash, _vertexCount);
+	hash = _hashValue(hash, (const void *)_drawTriangleFront);
+	hash = _hashValue(hash, (const void *)_drawTriangleBack);
+
+	hash = _hashValue(hash, _state.beginType);
+	hash = _hashValue(hash, _state.currentFrontFace);
+	hash = _hashValue(hash, _state.cullFaceEnabled);
+	hash = _hashValue(hash, _state.colorMask);
+	hash = _hashValue(hash, _state.depthTest);
+	hash = _hashValue(hash, _state.depthFunction);
+	hash = _hashValue(hash, _state.depthWrite);
+	hash = _hashValue(hash, _state.shadowMode);
+	hash = _hashValue(hash, _state.texture2DEnabled);
+	hash = _hashValue(hash, _state.currentShadeModel);
+	hash = _hashValue(hash, _state.polygonModeBack);
+	hash = _hashValue(hash, _state.polygonModeFront);
+	hash = _hashValue(hash, _state.lightingEnabled);
+	hash = _hashValue(hash, (int)_state.enableBlending);
+	hash = _hashValue(hash, _state.sfactor);
+	hash = _hashValue(hash, _state.dfactor);
+	hash = _hashValue(hash, _state.textureVersion);
+	hash = _hashValue(hash, _state.depthTestEnabled);
+	hash = _hashVector(hash, _state.viewportTranslation);
+	hash = _hashVector(hash, _state.viewportScaling);
+	hash = _hashValue(hash, (int)_state.alphaTest);
+	hash = _hashValue(hash, _state.alphaFunc);
+	hash = _hashValue(hash, _state.alphaRefValue);
+	hash = _hashValue(hash, (const void *)_state.texture);
+	hash = _hashValue(hash, (const void *)_state.shadowMaskBuf);
+
+	hash = _hashValue(hash, _indexCount);
+	for (int i = 0; i < _indexCount; i++) {
+		hash = _hashValue(hash, _indices[i]);
+	}
+
+	for (int i = 0; i < _vertexCount; i++) {
+		const TinyGL::GLVertex &v = _vertex[i];
+		hash = _hashValue(hash, v.edge_flag);
+		hash = _hashVector(hash, v.normal._v);
+		hash = _hashVector(hash, v.coord._v);
+		hash = _hashVector(hash, v.tex_coord._v);
+		hash = _hashVector(hash, v.color._v);
+		hash = _hashVector(hash, v.ec._v);
+		hash = _hashVector(hash, v.pc._v);
+		hash = _hashValue(hash, v.clip_code);
+		hash = _hashValue(hash, v.zp.x);
+		hash = _hashValue(hash, v.zp.y);
+		hash = _hashValue(hash, v.zp.z);
+		hash = _hashValue(hash, v.zp.s);
+		hash = _hashValue(hash, v.zp.t);
+		hash = _hashValue(hash, v.zp.r);
+		hash = _hashValue(hash, v.zp.g);
+		hash = _hashValue(hash, v.zp.b);
+		hash = _hashValue(hash, v.zp.a);
+	}
+	_hash = hash;
+}
+
 void RasterizationDrawCall::execute(bool restoreState) const {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 
@@ -373,8 +743,14 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		}
 		break;
 	case TGL_TRIANGLES:
-		for(int i = 0; i < cnt; i += 3) {
-			gl_draw_triangle(c, &c->vertex[i], &c->vertex[i + 1], &c->vertex[i + 2]);
+		if (_indexCount > 0) {
+			for (int i = 0; i < _indexCount; i += 3) {
+				gl_draw_triangle(c, &c->vertex[_indices[i]], &c->vertex[_indices[i + 1]], &c->vertex[_indices[i + 2]]);
+			}
+		} else {
+			for(int i = 0; i < cnt; i += 3) {
+				gl_draw_triangle(c, &c->vertex[i], &c->vertex[i + 1], &c->vertex[i + 2]);
+			}
 		}
 		break;
 	case TGL_TRIANGLE_STRIP:
@@ -458,8 +834,10 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	state.depthWrite = c->fb->getDepthWrite();
 	state.lightingEnabled = c->lighting_enabled;
 	state.depthTestEnabled = c->fb->getDepthTestEnabled();
-	if (c->current_texture != nullptr) 
+	if (c->current_texture != nullptr)
 		state.textureVersion = c->current_texture->versionNumber;
+	else
+		state.textureVersion = 0;
 
 	memcpy(state.viewportScaling, c->viewport.scale._v, sizeof(c->viewport.scale._v));
 	memcpy(state.viewportTranslation, c->viewport.trans._v, sizeof(c->viewport.trans._v));
@@ -504,6 +882,7 @@ void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool
 
 bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const {
 	if (_vertexCount == other._vertexCount && 
+		_indexCount == other._indexCount &&
 		_drawTriangleFront == other._drawTriangleFront && 
 		_drawTriangleBack == other._drawTriangleBack && 
 		_state == other._state) {
@@ -512,6 +891,11 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 				return false;
 			}
 		}
+		for (int i = 0; i < _indexCount; i++) {
+			if (_indices[i] != other._indices[i]) {
+				return false;
+			}
+		}
 		return true;
 	}
 	return false;
@@ -521,9 +905,46 @@ BlittingDrawCall::BlittingDrawCall(Graphics::BlitImage *image, const BlitTransfo
 	tglIncBlitImageRef(image);
 	_blitState = captureState();
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (TinyGL::gl_get_context()->_enableDirtyRectangles) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
+	if (c->_enableDirtyRectangles) {
+		computeHash();
+	}
+}
+
+void BlittingDrawCall::computeHash() {
+	uint32 hash = kHashSeed;
+	hash = _hashValue(hash, (int)_mode);
+	hash = _hashValue(hash, (const void *)_image);
+	hash = _hashValue(hash, _imageVersion);
+
+	const Common::Rect *rects[] = { &_transform._sourceRectangle, &_transform._destinationRectangle };
+	for (int i = 0; i < 2; i++) {
+		hash = _hashValue(hash, rects[i]->left);
+		hash = _hashValue(hash, rects[i]->top);
+		hash = _hashValue(hash, rects[i]->right);
+		hash = _hashValue(hash, rects[i]->bottom);
+	}
+	hash = _hashValue(hash, _transform._rotation);
+	hash = _hashValue(hash, _transform._originX);
+	hash = _hashValue(hash, _transform._originY);
+	hash = _hashValue(hash, _transform._aTint);
+	hash = _hashValue(hash, _transform._rTint);
+	hash = _hashValue(hash, _transform._gTint);
+	hash = _hashValue(hash, _transform._bTint);
+	hash = _hashValue(hash, (int)_transform._flipHorizontally);
+	hash = _hashValue(hash, (int)_transform._flipVertically);
+
+	hash = _hashValue(hash, (int)_blitState.enableBlending);
+	hash = _hashValue(hash, _blitState.sfactor);
+	hash = _hashValue(hash, _blitState.dfactor);
+	hash = _hashValue(hash, (int)_blitState.alphaTest);
+	hash = _hashValue(hash, _blitState.alphaFunc);
+	hash = _hashValue(hash, _blitState.alphaRefValue);
+	hash = _hashValue(hash, _blitState.depthTestEnabled);
+	_hash = hash;
 }
 
 BlittingDrawCall::~BlittingDrawCall() {
@@ -626,9 +1047,23 @@ bool BlittingDrawCall::operator==(const BlittingDrawCall &other) const {
 ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue) 
 	: _clearZBuffer(clearZBuffer), _clearColorBuffer(clearColorBuffer), _zValue(zValue), _rValue(rValue), _gValue(gValue), _bValue(bValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		_dirtyRegion = c->renderRect;
 	}
+	if (c->_enableDirtyRectangles) {
+		computeHash();
+	}
+}
+
+void ClearBufferDrawCall::computeHash() {
+	uint32 hash = kHashSeed;
+	hash = _hashValue(hash, (int)_clearZBuffer);
+	hash = _hashValue(hash, (int)_clearColorBuffer);
+	hash = _hashValue(hash, _rValue);
+	hash = _hashValue(hash, _gValue);
+	hash = _hashValue(hash, _bValue);
+	hash = _hashValue(hash, _zValue);
+	_hash = hash;
 }
 
 void ClearBufferDrawCall::execute(bool restoreState) const {
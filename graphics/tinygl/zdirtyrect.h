@@ -54,7 +54,7 @@ public:
 		DrawCall_Clear
 	};
 
-	DrawCall(DrawCallType type) : _type(type) { }
+	DrawCall(DrawCallType type) : _type(type), _hash(0) { }
 	virtual ~DrawCall() { }
 	bool operator==(const DrawCall &other) const;
 	bool operator!=(const DrawCall &other) const {
@@ -64,8 +64,11 @@ public:
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
+	// Hash of the draw call content: equal draw calls have equal hashes.
+	uint32 getHash() const { return _hash; }
 protected:
 	Common::Rect _dirtyRegion;
+	uint32 _hash;
 private:
 	DrawCallType _type;
 };
@@ -84,6 +87,7 @@ public:
 
 	void operator delete(void *p) { }
 private:
+	void computeHash();
 	bool _clearZBuffer, _clearColorBuffer;
 	int _rValue, _gValue, _bValue, _zValue;
 };
@@ -92,6 +96,7 @@ private:
 class RasterizationDrawCall : public DrawCall {
 public:
 	RasterizationDrawCall();
+	RasterizationDrawCall(const int *indices, int indexCount);
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
@@ -103,10 +108,14 @@ public:
 
 	void operator delete(void *p) { }
 private:
+	void init();
 	void computeDirtyRegion();
+	void computeHash();
 	typedef void (*gl_draw_triangle_func_ptr)(TinyGL::GLContext *c, TinyGL::GLVertex *p0, TinyGL::GLVertex *p1, TinyGL::GLVertex *p2);
 	int _vertexCount;
 	TinyGL::GLVertex *_vertex;
+	int _indexCount; // Triangles are drawn from indexed vertices if this is not zero.
+	int *_indices;
 	gl_draw_triangle_func_ptr _drawTriangleFront, _drawTriangleBack; 
 
 	struct RasterizationState {
@@ -168,6 +177,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void computeHash();
 	BlitImage *_image;
 	BlitTransform _transform;
 	BlittingMode _mode;
@@ -172,17 +172,31 @@ struct GLVertex {
 	}
 };
 
+// Texels of a texture image are stored in tiles of 4x4 texels, a tile being stored
+// line by line. Tiles of 32 bit texels are 64 bytes long, so that texels close to each other
+// on both axis are likely to share a cache line.
+#define TEXTURE_TILE_BITS 2
+#define TEXTURE_TILE_SIZE (1 << TEXTURE_TILE_BITS)
+
 struct GLImage {
 	Graphics::PixelBuffer pixmap;
 	int xsize, ysize;
+	int tilesPerLine;
 };
 
+static inline int gl_tiledTexelOffset(int x, int y, int tilesPerLine) {
+	return ((((y >> TEXTURE_TILE_BITS) * tilesPerLine + (x >> TEXTURE_TILE_BITS)) << (2 * TEXTURE_TILE_BITS)) |
+			((y & (TEXTURE_TILE_SIZE - 1)) << TEXTURE_TILE_BITS) | (x & (TEXTURE_TILE_SIZE - 1)));
+}
+
 // textures
 
 #define TEXTURE_HASH_TABLE_SIZE 256
 
 struct GLTexture {
 	GLImage images[MAX_TEXTURE_LEVELS];
+	int levelCount;
+	int minFilter, magFilter;
 	unsigned int handle;
 	int versionNumber;
 	struct GLTexture *next, *prev;
@@ -355,6 +369,9 @@ struct GLContext {
 	int texcoord_array_size;
 	int texcoord_array_stride;
 	int client_states;
+	// glDrawElements: for each array element, the index of its transformed vertex plus one
+	Common::Array<int> vertex_array_remap;
+	Common::Array<int> vertex_indices;
 
 	// opengl 1.1 polygon offset
 	float offset_factor;
@@ -382,12 +399,21 @@ struct GLContext {
 
 	bool _enableDirtyRectangles;
 
+	// tiled rendering
+	bool _enableTiledRendering;
+	int _tileWidth, _tileHeight;
+	Common::Array<Common::Array<Graphics::DrawCall *> > _tileBins;
+
+	// When disabled, every texture is sampled with TGL_NEAREST from its first level.
+	bool _enableTextureFiltering;
+
 	// blit test
 	Common::List<Graphics::BlitImage *> _blitImages;
 
-	// Draw call queue
-	Common::List<Graphics::DrawCall *> _drawCallsQueue;
-	Common::List<Graphics::DrawCall *> _previousFrameDrawCallsQueue;
+	// Draw call queue: draw calls are allocated from the allocator of their frame, and only
+	// released by resetting it. The arrays keep their storage from one frame to the next.
+	Common::Array<Graphics::DrawCall *> _drawCallsQueue;
+	Common::Array<Graphics::DrawCall *> _previousFrameDrawCallsQueue;
 	int _currentAllocatorIndex;
 	LinearAllocator _drawCallAllocator[2];
 };
@@ -420,10 +446,9 @@ void glEndTextures(GLContext *c);
 GLTexture *alloc_texture(GLContext *c, int h);
 void free_texture(GLContext *c, int h);
 void free_texture(GLContext *c, GLTexture *t);
+void gl_buildMipmaps(GLTexture *t);
 
 // image_util.c
-void gl_resizeImage(unsigned char *dest, int xsize_dest, int ysize_dest,
-					unsigned char *src, int xsize_src, int ysize_src);
 void gl_resizeImageNoInterpolate(unsigned char *dest, int xsize_dest, int ysize_dest,
 								 unsigned char *src, int xsize_src, int ysize_src);
 
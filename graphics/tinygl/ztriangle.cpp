@@ -34,21 +34,21 @@ namespace TinyGL {
 
 static const int NB_INTERP = 8;
 
-template <bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
+template <bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor, bool kEnableBlending>
 FORCEINLINE static void putPixelFlat(FrameBuffer *buffer, int buf, unsigned int *pz, int _a,
                                      int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a, int &dzdx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
-		buffer->writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth<kDepthFunc>(z, pz[_a])) {
+		buffer->writeFragment<kAlphaTestFunc, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
 }
 
-template <bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
+template <bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor, bool kEnableBlending>
 FORCEINLINE static void putPixelSmooth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a,
                                        int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
                                        int &dzdx, int &drdx, int &dgdx, int &dbdx, unsigned int dadx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
-		buffer->writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth<kDepthFunc>(z, pz[_a])) {
+		buffer->writeFragment<kAlphaTestFunc, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
 	a += dadx;
@@ -57,9 +57,9 @@ FORCEINLINE static void putPixelSmooth(FrameBuffer *buffer, int buf, unsigned in
 	b += dbdx;
 }
 
-template <bool kDepthWrite, bool kEnableScissor>
+template <bool kDepthWrite, int kDepthFunc, bool kEnableScissor>
 FORCEINLINE static void putPixelDepth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, int x, int y, unsigned int &z, int &dzdx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth<kDepthFunc>(z, pz[_a])) {
 		if (kDepthWrite) {
 			pz[_a] = z;
 		}
@@ -67,30 +67,124 @@ FORCEINLINE static void putPixelDepth(FrameBuffer *buffer, int buf, unsigned int
 	z += dzdx;
 }
 
-template <bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled>
+template <bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor, bool kBlendingEnabled>
 FORCEINLINE static void putPixelShadow(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, int &dzdx, unsigned char *pm) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a]) && pm[_a]) {
-		buffer->writePixel<kAlphaTestEnabled, kBlendingEnabled, kDepthWrite>(buf + _a, 255, r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth<kDepthFunc>(z, pz[_a]) && pm[_a]) {
+		buffer->writeFragment<kAlphaTestFunc, kBlendingEnabled, kDepthWrite>(buf + _a, 255, r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
 }
 
-template <bool kDepthWrite, bool kLightsMode, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
+// Texture image used to rasterize a triangle, chosen from the mip chain.
+struct TextureSampler {
+	const uint32 *texels;
+	int tilesPerLine;
+	unsigned int width, height; // size of the image, in texels
+	int coordShift; // shift from texture coordinates to 16 bit fractions of the texture size
+	bool linearFilter;
+	Graphics::PixelFormat format;
+};
+
+// Selects the mip level and the filter used to sample the texture on a triangle.
+// The level of detail is computed once per triangle from the ratio between its area
+// in texels and its area in pixels. *_MIPMAP_LINEAR filters use the nearest level as well.
+// Without texture filtering, the first level is sampled with TGL_NEAREST, except when
+// images smaller than the texture size are magnified: those used to be upscaled to it
+// with bilinear interpolation on upload, so they keep their magnification filter.
+static void setupTextureSampler(TextureSampler &sampler, const GLTexture *texture, int textureSize, bool filtering,
+                                const ZBufferPoint *p0, const ZBufferPoint *p1, const ZBufferPoint *p2, float invArea) {
+	// Texture coordinates are fixed point values in which the texture size is textureSize.
+	const GLImage &baseImage = texture->images[0];
+	float ds1 = (float)(p1->s - p0->s), dt1 = (float)(p1->t - p0->t);
+	float ds2 = (float)(p2->s - p0->s), dt2 = (float)(p2->t - p0->t);
+	float texelRatio = fabs((ds1 * dt2 - ds2 * dt1) * invArea) / (float)(1 << (2 * ZB_POINT_ST_FRAC_BITS));
+	texelRatio *= (float)(baseImage.xsize * baseImage.ysize) / (float)(textureSize * textureSize);
+
+	int filter = TGL_NEAREST;
+	int level = 0;
+	if (texelRatio <= 1.0f) {
+		if (filtering || baseImage.xsize < textureSize || baseImage.ysize < textureSize)
+			filter = texture->magFilter;
+	} else if (filtering) {
+		filter = texture->minFilter;
+		if (filter != TGL_NEAREST && filter != TGL_LINEAR) {
+			// Each level divides the texel area by 4: round log4(texelRatio) to the nearest level.
+			float threshold = 2.0f;
+			while (texelRatio > threshold && level < texture->levelCount - 1) {
+				threshold *= 4.0f;
+				level++;
+			}
+		}
+	}
+
+	const GLImage &image = texture->images[level];
+	sampler.texels = (const uint32 *)image.pixmap.getRawBuffer();
+	sampler.tilesPerLine = image.tilesPerLine;
+	sampler.width = image.xsize;
+	sampler.height = image.ysize;
+	int textureSizeBits = 0;
+	while ((1 << textureSizeBits) < textureSize) {
+		textureSizeBits++;
+	}
+	// glInit() rejects texture sizes below 4, which keeps the shift non-negative.
+	sampler.coordShift = textureSizeBits + ZB_POINT_ST_FRAC_BITS - 16;
+	sampler.linearFilter = filter == TGL_LINEAR || filter == TGL_LINEAR_MIPMAP_NEAREST || filter == TGL_LINEAR_MIPMAP_LINEAR;
+	sampler.format = image.pixmap.getFormat();
+	assert(sampler.format.bytesPerPixel == 4);
+}
+
+FORCEINLINE static uint32 sampleTexture(const TextureSampler &sampler, unsigned int s, unsigned int t) {
+	// Repeat the texture, then scale the position in the texture to the image size.
+	unsigned int sFraction = (s >> sampler.coordShift) & 0xFFFF;
+	unsigned int tFraction = (t >> sampler.coordShift) & 0xFFFF;
+
+	if (!sampler.linearFilter) {
+		int x = (sFraction * sampler.width) >> 16;
+		int y = (tFraction * sampler.height) >> 16;
+		return sampler.texels[gl_tiledTexelOffset(x, y, sampler.tilesPerLine)];
+	}
+
+	// Texel coordinates with 8 fractional bits, relative to texel centers.
+	int u = (int)((sFraction * sampler.width) >> 8) - 128;
+	int v = (int)((tFraction * sampler.height) >> 8) - 128;
+	int x0 = u >> 8, x1 = x0 + 1;
+	int y0 = v >> 8, y1 = y0 + 1;
+	if (x0 < 0)
+		x0 += sampler.width;
+	if (x1 == (int)sampler.width)
+		x1 = 0;
+	if (y0 < 0)
+		y0 += sampler.height;
+	if (y1 == (int)sampler.height)
+		y1 = 0;
+	unsigned int fx = u & 0xFF, fy = v & 0xFF;
+
+	// The four weights add up to 256, each pair of channels is blended at once.
+	unsigned int w11 = (fx * fy) >> 8;
+	unsigned int w10 = fx - w11;
+	unsigned int w01 = fy - w11;
+	unsigned int w00 = 256 - fx - fy + w11;
+	uint32 c00 = sampler.texels[gl_tiledTexelOffset(x0, y0, sampler.tilesPerLine)];
+	uint32 c10 = sampler.texels[gl_tiledTexelOffset(x1, y0, sampler.tilesPerLine)];
+	uint32 c01 = sampler.texels[gl_tiledTexelOffset(x0, y1, sampler.tilesPerLine)];
+	uint32 c11 = sampler.texels[gl_tiledTexelOffset(x1, y1, sampler.tilesPerLine)];
+	uint32 evenChannels = (c00 & 0x00FF00FF) * w00 + (c10 & 0x00FF00FF) * w10 + (c01 & 0x00FF00FF) * w01 + (c11 & 0x00FF00FF) * w11;
+	uint32 oddChannels = ((c00 >> 8) & 0x00FF00FF) * w00 + ((c10 >> 8) & 0x00FF00FF) * w10 + ((c01 >> 8) & 0x00FF00FF) * w01 + ((c11 >> 8) & 0x00FF00FF) * w11;
+	return ((evenChannels >> 8) & 0x00FF00FF) | (oddChannels & 0xFF00FF00);
+}
+
+template <bool kDepthWrite, int kDepthFunc, bool kLightsMode, bool kSmoothMode, int kAlphaTestFunc, bool kEnableScissor, bool kEnableBlending>
 FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, int buf,
-                        Graphics::PixelFormat &textureFormat, Graphics::PixelBuffer &texture, unsigned int *pz, int _a,
+                        const TextureSampler &sampler, unsigned int *pz, int _a,
                         int x, int y, unsigned int &z, unsigned int &t, unsigned int &s, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
                         int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, unsigned int dadx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
-		unsigned sss = (s & buffer->_textureSizeMask) >> ZB_POINT_ST_FRAC_BITS;
-		unsigned ttt = (t & buffer->_textureSizeMask) >> ZB_POINT_ST_FRAC_BITS;
-		int pixel = ttt * buffer->_textureSize + sss;
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth<kDepthFunc>(z, pz[_a])) {
 		uint8 c_a, c_r, c_g, c_b;
-		uint32 *textureBuffer = (uint32 *)texture.getRawBuffer(pixel);
-		uint32 col = *textureBuffer;
-		c_a = (col >> textureFormat.aShift) & 0xFF;
-		c_r = (col >> textureFormat.rShift) & 0xFF;
-		c_g = (col >> textureFormat.gShift) & 0xFF;
-		c_b = (col >> textureFormat.bShift) & 0xFF;
+		uint32 col = sampleTexture(sampler, s, t);
+		c_a = (col >> sampler.format.aShift) & 0xFF;
+		c_r = (col >> sampler.format.rShift) & 0xFF;
+		c_g = (col >> sampler.format.gShift) & 0xFF;
+		c_b = (col >> sampler.format.bShift) & 0xFF;
 		if (kLightsMode) {
 			unsigned int l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
 			unsigned int l_r = (r >> (ZB_POINT_RED_BITS - 8));
@@ -101,7 +195,7 @@ FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, i
 			c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
 			c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
 		}
-		buffer->writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(buf + _a, c_a, c_r, c_g, c_b, z);
+		buffer->writeFragment<kAlphaTestFunc, kEnableBlending, kDepthWrite>(buf + _a, c_a, c_r, c_g, c_b, z);
 	}
 	z += dzdx;
 	s += dsdx;
@@ -114,10 +208,9 @@ FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, i
 	}
 }
 
-template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled>
+template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor, bool kBlendingEnabled>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
-	Graphics::PixelBuffer texture;
-	Graphics::PixelFormat textureFormat;
+	TextureSampler sampler;
 	float fdzdx = 0, fndzdx = 0, ndszdx = 0, ndtzdx = 0;
 
 	ZBufferPoint *tp, *pr1 = 0, *pr2 = 0, *l1 = 0, *l2 = 0;
@@ -269,9 +362,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 	}
 
 	if ((kInterpST || kInterpSTZ) && (kDrawLogic == DRAW_FLAT || kDrawLogic == DRAW_SMOOTH)) {
-		texture = current_texture;
-		textureFormat = texture.getFormat();
-		assert(textureFormat.bytesPerPixel == 4);
+		setupTextureSampler(sampler, current_texture, _textureSize, _textureFiltering, p0, p1, p2, fz0);
 		fdzdx = (float)dzdx;
 		fndzdx = NB_INTERP * fdzdx;
 		ndszdx = NB_INTERP * dszdx;
@@ -371,7 +462,8 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			{
+			// Scan lines outside of the scissor rectangle are only stepped through.
+			if (!kEnableScissor || (y >= _clipRectangle.top && y < _clipRectangle.bottom)) {
 				if (kDrawLogic == DRAW_DEPTH_ONLY ||
 						(kDrawLogic == DRAW_FLAT && !(kInterpST || kInterpSTZ))) {
 					int pp;
@@ -393,17 +485,17 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					}
 					while (n >= 3) {
 						if (kDrawLogic == DRAW_DEPTH_ONLY) {
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 1, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 2, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 3, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kDepthFunc, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kDepthFunc, kEnableScissor>(this, buf, pz, 1, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kDepthFunc, kEnableScissor>(this, buf, pz, 2, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kDepthFunc, kEnableScissor>(this, buf, pz, 3, x, y, z, dzdx);
 							buf += 4;
 						}
 						if (kDrawLogic == DRAW_FLAT) {
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, g, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
 							pz += 4;
@@ -414,11 +506,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					}
 					while (n >= 0) {
 						if (kDrawLogic == DRAW_DEPTH_ONLY) {
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kDepthFunc, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
 							buf ++;
 						}
 						if (kDrawLogic == DRAW_FLAT) {
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
 							pz += 1;
@@ -433,6 +525,15 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 					n = (x2 >> 16) - x1;
 					pm = pm1 + x1;
+					if (kEnableScissor) {
+						while (n >= 0) {
+							if (!scissorPixel(x, y))
+								pm[0] = 0xff;
+							pm += 1;
+							n -= 1;
+							x += 1;
+						}
+					}
 					while (n >= 3) {
 						pm[0] = 0xff;
 						pm[1] = 0xff;
@@ -465,10 +566,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					pz = pz1 + x1;
 					z = z1;
 					while (n >= 3) {
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, dzdx, pm);
 						pz += 4;
 						pm += 4;
 						buf += 4;
@@ -476,7 +577,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						x += 4;
 					}
 					while (n >= 0) {
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
 						pz += 1;
 						pm += 1;
 						buf += 1;
@@ -496,17 +597,17 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					b = b1;
 					a = a1;
 					while (n >= 3) {
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
 						pz += 4;
 						buf += 4;
 						n -= 4;
 						x += 4;
 					}
 					while (n >= 0) {
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
 						buf += 1;
 						pz += 1;
 						n -= 1;
@@ -546,7 +647,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 							zinv = (float)(1.0 / fz);
 						}
 						for (int _a = 0; _a < NB_INTERP; _a++) {
-							putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, textureFormat, texture,
+							putPixelTextureMappingPerspective<kDepthWrite, kDepthFunc, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, sampler,
 							                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
 						}
 						pz += NB_INTERP;
@@ -568,7 +669,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					}
 
 					while (n >= 0) {
-						putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, textureFormat, texture,
+						putPixelTextureMappingPerspective<kDepthWrite, kDepthFunc, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestFunc, kEnableScissor, kBlendingEnabled>(this, buf, sampler,
 						                           pz, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
 						pz += 1;
 						buf += 1;
@@ -630,30 +731,51 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 	}
 }
 
-template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor>
+template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc, bool kEnableScissor>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
 	if (_blendingEnabled) {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kEnableAlphaTest, kEnableScissor, true>(p0, p1, p2);
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, true>(p0, p1, p2);
 	} else {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kEnableAlphaTest, kEnableScissor, false>(p0, p1, p2);
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kAlphaTestFunc, kEnableScissor, false>(p0, p1, p2);
 	}
 }
 
-template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, bool kEnableAlphaTest>
+template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc, int kAlphaTestFunc>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
 	if (_enableScissor) {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kEnableAlphaTest, true>(p0, p1, p2);
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kAlphaTestFunc, true>(p0, p1, p2);
+	} else {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kAlphaTestFunc, false>(p0, p1, p2);
+	}
+}
+
+// The depth and alpha tests are resolved at compile time for the functions used by the engines,
+// the other ones go through the generic test. Draw modes not using a test only get one variant,
+// and the alpha test function is only specialized for textured triangles.
+template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite, int kDepthFunc>
+void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
+	const bool kUsesAlphaTest = kDrawMode != DRAW_DEPTH_ONLY && kDrawMode != DRAW_SHADOW_MASK;
+	const bool kTextured = kInterpST || kInterpSTZ;
+	if (!kUsesAlphaTest || !_alphaTestEnabled) {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, TGL_ALWAYS>(p0, p1, p2);
+	} else if (kTextured && _alphaTestFunc == TGL_GEQUAL) {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kTextured ? TGL_GEQUAL : TGL_ALWAYS>(p0, p1, p2);
 	} else {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kEnableAlphaTest, false>(p0, p1, p2);
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kDepthFunc, kUsesAlphaTest ? TEST_FUNC_RUNTIME : TGL_ALWAYS>(p0, p1, p2);
 	}
 }
 
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawMode, bool kDepthWrite>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
-	if (_alphaTestEnabled) {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, true>(p0, p1, p2);
-	}  else {
-		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, false>(p0, p1, p2);
+	const bool kUsesDepthTest = kDrawMode != DRAW_SHADOW_MASK;
+	if (!kUsesDepthTest) {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, TGL_ALWAYS>(p0, p1, p2);
+	} else if (_depthTestEnabled && _depthFunc == TGL_LESS) {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kUsesDepthTest ? TGL_LESS : TGL_ALWAYS>(p0, p1, p2);
+	} else if (_depthTestEnabled && _depthFunc == TGL_LEQUAL) {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kUsesDepthTest ? TGL_LEQUAL : TGL_ALWAYS>(p0, p1, p2);
+	} else {
+		fillTriangle<kInterpRGB, kInterpZ, kInterpST, kInterpSTZ, kDrawMode, kDepthWrite, kUsesDepthTest ? TEST_FUNC_RUNTIME : TGL_ALWAYS>(p0, p1, p2);
 	}
 }
 
@@ -30,6 +30,7 @@
 #include "common/endian.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
+#include "common/util.h"
 #include "graphics/pixelformat.h"
 
 #ifdef USE_JPEG
@@ -44,7 +45,11 @@ extern "C" {
 
 namespace Image {
 
-JPEGDecoder::JPEGDecoder() : _surface(), _colorSpace(kColorSpaceRGBA) {
+JPEGDecoder::JPEGDecoder() :
+		_surface(),
+		_outputSurface(0),
+		_colorSpace(kColorSpaceRGBA),
+		_pixelFormat(4, 8, 8, 8, 0, 24, 16, 8, 0) {
 }
 
 JPEGDecoder::~JPEGDecoder() {
@@ -52,7 +57,7 @@ JPEGDecoder::~JPEGDecoder() {
 }
 
 const Graphics::Surface *JPEGDecoder::getSurface() const {
-	return &_surface;
+	return _outputSurface ? _outputSurface : &_surface;
 }
 
 void JPEGDecoder::destroy() {
@@ -67,7 +72,12 @@ const Graphics::Surface *JPEGDecoder::decodeFrame(Common::SeekableReadStream &st
 }
 
 Graphics::PixelFormat JPEGDecoder::getPixelFormat() const {
-	return _surface.format;
+	return getSurface()->format;
+}
+
+void JPEGDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4);
+	_pixelFormat = format;
 }
 
 #ifdef USE_JPEG
@@ -171,6 +181,46 @@ void outputMessage(j_common_ptr cinfo) {
 	debug(3, "libjpeg: %s", buffer);
 }
 
+/**
+ * Get the libjpeg-turbo extended color space writing the pixels
+ * in the specified format, or JCS_UNKNOWN if there is none.
+ */
+J_COLOR_SPACE getExtendedColorSpace(const Graphics::PixelFormat &format) {
+#ifdef JCS_ALPHA_EXTENSIONS
+	if (format.bytesPerPixel != 4 || format.rLoss != 0 || format.gLoss != 0 || format.bLoss != 0)
+		return JCS_UNKNOWN;
+
+	if (format.aLoss != 0 && format.aLoss != 8)
+		return JCS_UNKNOWN;
+
+	if ((format.rShift | format.gShift | format.bShift) & 7)
+		return JCS_UNKNOWN;
+
+	// Position of the components in memory. The alpha byte, or the unused
+	// byte, is the remaining one. libjpeg-turbo always sets it to 0xFF.
+#ifdef SCUMM_BIG_ENDIAN
+	int r = 3 - format.rShift / 8;
+	int g = 3 - format.gShift / 8;
+	int b = 3 - format.bShift / 8;
+#else
+	int r = format.rShift / 8;
+	int g = format.gShift / 8;
+	int b = format.bShift / 8;
+#endif
+
+	if (g == 1 && r == 0 && b == 2)
+		return JCS_EXT_RGBA;
+	if (g == 1 && r == 2 && b == 0)
+		return JCS_EXT_BGRA;
+	if (g == 2 && r == 1 && b == 3)
+		return JCS_EXT_ARGB;
+	if (g == 2 && r == 3 && b == 1)
+		return JCS_EXT_ABGR;
+#endif
+
+	return JCS_UNKNOWN;
+}
+
 } // End of anonymous namespace
 #endif
 
@@ -197,70 +247,75 @@ bool JPEGDecoder::loadStream(Common::SeekableReadStream &stream) {
 	jpeg_read_header(&cinfo, TRUE);
 
 	// We can request YUV output because Groovie requires it
+	Graphics::PixelFormat format;
 	switch (_colorSpace) {
 	case kColorSpaceRGBA:
-		cinfo.out_color_space = JCS_RGB;
+		// Let libjpeg write the requested format directly when it can
+		cinfo.out_color_space = getExtendedColorSpace(_pixelFormat);
+		if (cinfo.out_color_space == JCS_UNKNOWN)
+			cinfo.out_color_space = JCS_RGB;
+		format = _pixelFormat;
 		break;
 
 	case kColorSpaceYUV:
 		cinfo.out_color_space = JCS_YCbCr;
+		// We use YUV with 3 bytes per pixel.
+		// This is pretty ugly since our PixelFormat cannot express YUV...
+		format = Graphics::PixelFormat(3, 0, 0, 0, 0, 0, 0, 0, 0);
 		break;
 	}
 
 	// Actually start decompressing the image
 	jpeg_start_decompress(&cinfo);
 
-	// Allocate buffers for the output data
-	switch (_colorSpace) {
-	case kColorSpaceRGBA:
-		// We use RGBA8888 in this scenario
-		_surface.create(cinfo.output_width, cinfo.output_height, Graphics::PixelFormat(4, 8, 8, 8, 0, 24, 16, 8, 0));
-		break;
-
-	case kColorSpaceYUV:
-		// We use YUV with 3 bytes per pixel otherwise.
-		// This is pretty ugly since our PixelFormat cannot express YUV...
-		_surface.create(cinfo.output_width, cinfo.output_height, Graphics::PixelFormat(3, 0, 0, 0, 0, 0, 0, 0, 0));
-		break;
+	// Allocate the output surface, unless the caller's one can be reused
+	Graphics::Surface *surface = _outputSurface ? _outputSurface : &_surface;
+	if (!surface->getPixels() || surface->w != (int)cinfo.output_width || surface->h != (int)cinfo.output_height
+			|| surface->format != format) {
+		surface->free();
+		surface->create(cinfo.output_width, cinfo.output_height, format);
 	}
 
-	// Allocate buffer for one scanline
-	assert(cinfo.output_components == 3);
-	JDIMENSION pitch = cinfo.output_width * cinfo.output_components;
-	assert(_surface.pitch >= pitch);
-	JSAMPARRAY buffer = (*cinfo.mem->alloc_sarray)((j_common_ptr)&cinfo, JPOOL_IMAGE, pitch, 1);
-
-	// Go through the image data scanline by scanline
-	while (cinfo.output_scanline < cinfo.output_height) {
-		byte *dst = (byte *)_surface.getBasePtr(0, cinfo.output_scanline);
-
-		jpeg_read_scanlines(&cinfo, buffer, 1);
-
-		const byte *src = buffer[0];
-		switch (_colorSpace) {
-		case kColorSpaceRGBA: {
-			for (int remaining = cinfo.output_width; remaining > 0; --remaining) {
-				byte r = *src++;
-				byte g = *src++;
-				byte b = *src++;
-				// We need to insert a alpha value of 255 (opaque) here.
-#ifdef SCUMM_BIG_ENDIAN
-				*dst++ = r;
-				*dst++ = g;
-				*dst++ = b;
-				*dst++ = 0xFF;
-#else
-				*dst++ = 0xFF;
-				*dst++ = b;
-				*dst++ = g;
-				*dst++ = r;
-#endif
-			}
-			} break;
+	if (cinfo.out_color_space != JCS_RGB) {
+		// libjpeg outputs the surface format, decode straight into the surface
+		JSAMPROW rows[16];
+		while (cinfo.output_scanline < cinfo.output_height) {
+			JDIMENSION count = MIN<JDIMENSION>(ARRAYSIZE(rows), cinfo.output_height - cinfo.output_scanline);
+			for (JDIMENSION i = 0; i < count; i++)
+				rows[i] = (JSAMPROW)surface->getBasePtr(0, cinfo.output_scanline + i);
 
-		case kColorSpaceYUV:
-			memcpy(dst, src, pitch);
-			break;
+			jpeg_read_scanlines(&cinfo, rows, count);
+		}
+	} else {
+		// Allocate buffers for the scanlines libjpeg outputs at once
+		assert(cinfo.output_components == 3);
+		JDIMENSION pitch = cinfo.output_width * cinfo.output_components;
+		JSAMPARRAY buffer = (*cinfo.mem->alloc_sarray)((j_common_ptr)&cinfo, JPOOL_IMAGE, pitch, cinfo.rec_outbuf_height);
+
+		// Formats without alpha get the unused bits set, as if the pixels were opaque
+		uint32 padding = 0;
+		if (format.bytesPerPixel == 4 && format.aBits() == 0)
+			padding = ~format.RGBToColor(0xFF, 0xFF, 0xFF);
+
+		while (cinfo.output_scanline < cinfo.output_height) {
+			JDIMENSION first = cinfo.output_scanline;
+			JDIMENSION count = jpeg_read_scanlines(&cinfo, buffer, cinfo.rec_outbuf_height);
+
+			for (JDIMENSION i = 0; i < count; i++) {
+				const byte *src = buffer[i];
+				byte *dst = (byte *)surface->getBasePtr(0, first + i);
+
+				for (int remaining = cinfo.output_width; remaining > 0; --remaining) {
+					uint32 color = format.RGBToColor(src[0], src[1], src[2]) | padding;
+					src += 3;
+
+					if (format.bytesPerPixel == 2)
+						*(uint16 *)dst = color;
+					else
+						*(uint32 *)dst = color;
+					dst += format.bytesPerPixel;
+				}
+			}
 		}
 	}
 
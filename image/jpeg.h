@@ -92,9 +92,33 @@ public:
 	 */
 	void setOutputColorSpace(ColorSpace outSpace) { _colorSpace = outSpace; }
 
+	/**
+	 * Request the pixel format of the RGBA color space output.
+	 *
+	 * When libjpeg supports writing this format, the image is decoded
+	 * directly in it. Otherwise, the pixels are converted after decoding.
+	 *
+	 * The decoder defaults to RGBA8888 with an unused alpha byte.
+	 *
+	 * @param format The pixel format to output, with 2 or 4 bytes per pixel.
+	 */
+	void setOutputPixelFormat(const Graphics::PixelFormat &format);
+
+	/**
+	 * Decode into a surface owned by the caller instead of an internal one.
+	 *
+	 * The surface is only reallocated when its size or format do not match
+	 * the decoded image. getSurface returns it after a successful decoding.
+	 *
+	 * @param surface The surface to decode into, or 0 to use the internal surface.
+	 */
+	void setOutputSurface(Graphics::Surface *surface) { _outputSurface = surface; }
+
 private:
 	Graphics::Surface _surface;
+	Graphics::Surface *_outputSurface;
 	ColorSpace _colorSpace;
+	Graphics::PixelFormat _pixelFormat;
 };
 
 } // End of namespace Image
@@ -0,0 +1,162 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * Convert a sine with the given rates, and compare the output with a
+	 * reference converter picking the input frame at index 'first + i * step'
+	 * for the output frame i.
+	 */
+	void resampleTestTemplate(const int inRate, const int outRate, const int first, const int step, const bool isStereo, const bool reverseStereo) {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, &sine, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+
+		const int volL = 200, volR = 100;
+		const int outFrames = (inRate - first + step - 1) / step;
+
+		// Start from a non silent buffer, so that clipping also happens
+		int16 *buffer = new int16[outFrames * 2];
+		for (int i = 0; i < outFrames * 2; ++i)
+			buffer[i] = (i % 3) * 15000;
+
+		// Convert in uneven chunks, to check the converter state is kept between calls
+		int done = 0;
+		while (done < outFrames) {
+			int chunk = MIN(outFrames - done, 333);
+			TS_ASSERT_EQUALS(converter->flow(*s, buffer + done * 2, chunk, volL, volR), chunk);
+			done += chunk;
+		}
+
+		const int channels = isStereo ? 2 : 1;
+		for (int i = 0; i < outFrames; ++i) {
+			const int frame = first + i * step;
+			const int in0 = sine[frame * channels];
+			const int in1 = sine[frame * channels + channels - 1];
+
+			const int left = reverseStereo ? 1 : 0;
+			const int expectedLeft = CLIP<int>((2 * i + left) % 3 * 15000 + in0 * volL / Audio::Mixer::kMaxMixerVolume, -32768, 32767);
+			const int expectedRight = CLIP<int>((2 * i + 1 - left) % 3 * 15000 + in1 * volR / Audio::Mixer::kMaxMixerVolume, -32768, 32767);
+			TS_ASSERT_EQUALS(buffer[2 * i + left], expectedLeft);
+			TS_ASSERT_EQUALS(buffer[2 * i + 1 - left], expectedRight);
+		}
+
+		delete[] sine;
+		delete[] buffer;
+		delete converter;
+		delete s;
+	}
+
+	/**
+	 * Upsample a sine with the windowed sinc converter, and compare the output
+	 * with the sine evaluated at the time of each output frame.
+	 */
+	void sincUpsampleTestTemplate(const int inRate, const int outRate, const bool isStereo, const bool reverseStereo) {
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo, true);
+
+		// The whole second of input is converted
+		const int outFrames = outRate;
+		int16 *buffer = new int16[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+
+		int done = 0;
+		while (done < outFrames) {
+			int chunk = MIN(outFrames - done, 333);
+			TS_ASSERT_EQUALS(converter->flow(*s, buffer + done * 2, chunk, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), chunk);
+			done += chunk;
+		}
+		TS_ASSERT_EQUALS(converter->flow(*s, buffer, 1, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 0);
+
+		// The sine has a period of inRate samples, interleaved for stereo
+		const int channels = isStereo ? 2 : 1;
+		const int left = reverseStereo ? 1 : 0;
+		for (int i = 0; i < outFrames; ++i) {
+			const double frame = (double)i * inRate / outRate;
+			const int in0 = (int)(sin(frame * channels / inRate * 2 * M_PI) * 32767);
+			const int in1 = (int)(sin((frame * channels + channels - 1) / inRate * 2 * M_PI) * 32767);
+			// The filter reaches 8 frames past the last input frame, where it gets silence instead of the sine
+			const int delta = frame < inRate - 8 ? 4 : 32;
+
+			TS_ASSERT_DELTA(buffer[2 * i + left], in0, delta);
+			TS_ASSERT_DELTA(buffer[2 * i + 1 - left], in1, delta);
+		}
+
+		delete[] buffer;
+		delete converter;
+		delete s;
+	}
+
+public:
+	void test_copy_mono() {
+		resampleTestTemplate(11025, 11025, 0, 1, false, false);
+	}
+
+	void test_copy_stereo() {
+		resampleTestTemplate(11025, 11025, 0, 1, true, false);
+	}
+
+	void test_copy_reverse_stereo() {
+		resampleTestTemplate(11025, 11025, 0, 1, true, true);
+	}
+
+	void test_simple_mono() {
+		resampleTestTemplate(44100, 22050, 1, 2, false, false);
+	}
+
+	void test_simple_stereo() {
+		resampleTestTemplate(33075, 11025, 1, 3, true, false);
+	}
+
+	void test_simple_reverse_stereo() {
+		resampleTestTemplate(44100, 11025, 1, 4, true, true);
+	}
+
+	void test_linear_upsample_mono() {
+		const int inRate = 11025;
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, &sine, false, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, inRate * 2, false, false);
+
+		const int outFrames = inRate * 2;
+		int16 *buffer = new int16[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+
+		TS_ASSERT_EQUALS(converter->flow(*s, buffer, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		// Every second output frame is an input frame, the others are halfway between two input frames
+		int previous = 0;
+		for (int i = 0; i < inRate; ++i) {
+			const int halfway = previous + (((sine[i] - previous) * 16384 + 16384) >> 15);
+			TS_ASSERT_EQUALS(buffer[4 * i], previous);
+			TS_ASSERT_EQUALS(buffer[4 * i + 1], previous);
+			TS_ASSERT_EQUALS(buffer[4 * i + 2], halfway);
+			TS_ASSERT_EQUALS(buffer[4 * i + 3], halfway);
+			previous = sine[i];
+		}
+
+		delete[] sine;
+		delete[] buffer;
+		delete converter;
+		delete s;
+	}
+
+	void test_sinc_upsample_mono() {
+		sincUpsampleTestTemplate(22050, 48000, false, false);
+	}
+
+	void test_sinc_upsample_stereo() {
+		sincUpsampleTestTemplate(11025, 48000, true, false);
+	}
+
+	void test_sinc_upsample_reverse_stereo() {
+		sincUpsampleTestTemplate(22050, 44100, true, true);
+	}
+};